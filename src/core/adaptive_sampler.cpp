@@ -0,0 +1,92 @@
+#include "adaptive_sampler.hpp"
+#include "memory_tracker.hpp"
+#include "renderer.hpp"
+
+namespace {
+
+// refineGroups[3] and refineCount ahead of the pixel list
+const size_t REFINE_LIST_HEADER = sizeof(GLuint) * 4;
+
+} // namespace
+
+AdaptiveSampler::~AdaptiveSampler() {
+    glDeleteProgram(classifyProgram);
+    glDeleteProgram(refineProgram);
+    MemoryTracker::get().releaseBuffer(pixelInfoBuffer);
+    MemoryTracker::get().releaseBuffer(refineListBuffer);
+    glDeleteBuffers(1, &pixelInfoBuffer);
+    glDeleteBuffers(1, &refineListBuffer);
+}
+
+void AdaptiveSampler::configure(int samples, const std::vector<std::string>& tracerDefines) {
+    if (classifyProgram == 0) {
+        classifyProgram = Renderer::createComputeProgram("shaders/adaptive/classify.comp",
+                                                         {"ADAPTIVE_GROUP_SIZE " + std::to_string(GROUP_SIZE)});
+        classifyRegionSizeLoc = glGetUniformLocation(classifyProgram, "regionSize");
+        classifyPixelOffsetLoc = glGetUniformLocation(classifyProgram, "pixelOffset");
+        contrastThresholdLoc = glGetUniformLocation(classifyProgram, "contrastThreshold");
+    }
+    if (refineProgram != 0 && samples == sampleCount && tracerDefines == refineDefines) {
+        return;
+    }
+    std::vector<std::string> defines = tracerDefines;
+    defines.push_back("ADAPTIVE_REFINE");
+    defines.push_back("ADAPTIVE_SAMPLES " + std::to_string(samples));
+    defines.push_back("ADAPTIVE_GROUP_SIZE " + std::to_string(GROUP_SIZE));
+    defines.push_back("LOCAL_SIZE_X " + std::to_string(GROUP_SIZE));
+    defines.push_back("LOCAL_SIZE_Y 1");
+    GLuint program = Renderer::createComputeProgram("shaders/raytracer.comp", defines);
+    glDeleteProgram(refineProgram);
+    refineProgram = program;
+    sampleCount = samples;
+    refineDefines = tracerDefines;
+}
+
+void AdaptiveSampler::begin(const glm::ivec2& regionOrigin, const glm::ivec2& size) {
+    origin = regionOrigin;
+    regionSize = size;
+    const size_t pixels = static_cast<size_t>(size.x) * size.y;
+    if (pixels > pixelCapacity) {
+        if (pixelInfoBuffer == 0) {
+            glGenBuffers(1, &pixelInfoBuffer);
+            glGenBuffers(1, &refineListBuffer);
+        }
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, pixelInfoBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, pixels * sizeof(GLuint), nullptr, GL_DYNAMIC_COPY);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, refineListBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, REFINE_LIST_HEADER + pixels * sizeof(GLuint), nullptr,
+                     GL_DYNAMIC_COPY);
+        pixelCapacity = pixels;
+        MemoryTracker::get().trackBuffer(pixelInfoBuffer, pixels * sizeof(GLuint), MemoryCategory::Sampling);
+        MemoryTracker::get().trackBuffer(refineListBuffer, REFINE_LIST_HEADER + pixels * sizeof(GLuint),
+                                         MemoryCategory::Sampling);
+    }
+
+    // No refine groups and an empty list until classify appends to it
+    const GLuint header[4] = {0, 1, 1, 0};
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, refineListBuffer);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(header), header);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, PIXEL_INFO_BINDING, pixelInfoBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, REFINE_LIST_BINDING, refineListBuffer);
+}
+
+void AdaptiveSampler::refine(GLuint outputTexture, GLenum imageFormat, float contrastThreshold) {
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    glUseProgram(classifyProgram);
+    glUniform2i(classifyRegionSizeLoc, regionSize.x, regionSize.y);
+    glUniform2i(classifyPixelOffsetLoc, origin.x, origin.y);
+    glUniform1f(contrastThresholdLoc, contrastThreshold);
+    glDispatchCompute((regionSize.x + 7) / 8, (regionSize.y + 7) / 8, 1);
+
+    // The refine pass reads its own 1 spp colour back from the image
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+    glUseProgram(refineProgram);
+    glBindImageTexture(0, outputTexture, 0, GL_FALSE, 0, GL_READ_WRITE, imageFormat);
+    glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, refineListBuffer);
+    glDispatchComputeIndirect(0);
+    glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, 0);
+}
+
+std::vector<std::string> AdaptiveSampler::getTracerDefines() {
+    return {"ADAPTIVE_SAMPLING"};
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+
+// Adaptive supersampling for the single-view megakernel. The 1 spp trace
+// also records each pixel's hit object and luminance; a classify pass then
+// lists the pixels on object silhouettes or sharp contrast steps, and a
+// refine variant of the tracer re-traces only those with jittered rays,
+// launched by an indirect dispatch sized from the list on the GPU.
+class AdaptiveSampler {
+public:
+    static const GLuint PIXEL_INFO_BINDING = 9;   // matches adaptive.glsl
+    static const GLuint REFINE_LIST_BINDING = 10;
+    static const int GROUP_SIZE = 64;             // refine invocations per workgroup
+
+    AdaptiveSampler() = default;
+    ~AdaptiveSampler();
+
+    AdaptiveSampler(const AdaptiveSampler&) = delete;
+    AdaptiveSampler& operator=(const AdaptiveSampler&) = delete;
+
+    // Rebuilds the refine program when the sample count or the tracer
+    // defines it shares with the 1 spp pass (image format, camera) change
+    void configure(int samples, const std::vector<std::string>& tracerDefines);
+    // Before the 1 spp dispatch: sizes and binds the buffers for a region
+    // of `regionSize` pixels from `origin`
+    void begin(const glm::ivec2& origin, const glm::ivec2& regionSize);
+    // After it: flags edge pixels and re-traces them into `outputTexture`.
+    // Frame constants and objects must still be bound.
+    void refine(GLuint outputTexture, GLenum imageFormat, float contrastThreshold);
+
+    // Defines the 1 spp tracer needs to record pixel info
+    static std::vector<std::string> getTracerDefines();
+
+private:
+    GLuint classifyProgram{0};
+    GLuint refineProgram{0};
+    GLuint pixelInfoBuffer{0};
+    GLuint refineListBuffer{0};
+    size_t pixelCapacity{0};
+    int sampleCount{0};
+    std::vector<std::string> refineDefines;
+    glm::ivec2 origin{0};
+    glm::ivec2 regionSize{0};
+    GLint classifyRegionSizeLoc{-1};
+    GLint classifyPixelOffsetLoc{-1};
+    GLint contrastThresholdLoc{-1};
+};
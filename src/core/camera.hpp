@@ -73,8 +73,22 @@ public:
         yaw = glm::degrees(atan2(front.z, front.x));
     }
 
-    void update([[maybe_unused]] float deltaTime) {
-        physics.updateCameraPosition(position);
+    void update(float deltaTime) {
+        physics.updateCameraPosition(position, deltaTime);
+    }
+
+    // Front vector after turning by a mouse movement from `from`, without
+    // touching this camera. Used to late-latch the view orientation.
+    glm::vec3 turnedFront(const glm::vec3& from, float xoffset, float yoffset) const {
+        float fromPitch = glm::degrees(asin(glm::clamp(from.y, -1.0f, 1.0f)));
+        float fromYaw = glm::degrees(atan2(from.z, from.x));
+        float newYaw = fromYaw + xoffset * mouseSensitivity;
+        float newPitch = glm::clamp(fromPitch + yoffset * mouseSensitivity, -89.0f, 89.0f);
+        glm::vec3 turned;
+        turned.x = cos(glm::radians(newYaw)) * cos(glm::radians(newPitch));
+        turned.y = sin(glm::radians(newPitch));
+        turned.z = sin(glm::radians(newYaw)) * cos(glm::radians(newPitch));
+        return glm::normalize(turned);
     }
 
     glm::vec3 getPosition() const { return position; }
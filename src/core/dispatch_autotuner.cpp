@@ -0,0 +1,152 @@
+#include "dispatch_autotuner.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+namespace {
+
+const int WARMUP_FRAMES = 2;
+const int TIMED_FRAMES = 5;
+
+std::string glString(GLenum name) {
+    const GLubyte* value = glGetString(name);
+    return value ? reinterpret_cast<const char*>(value) : "unknown";
+}
+
+} // namespace
+
+DispatchAutotuner::DispatchAutotuner(std::string path)
+    : cachePath(std::move(path)) {}
+
+std::vector<DispatchConfig> DispatchAutotuner::defaultCandidates() {
+    std::vector<DispatchConfig> candidates;
+    const int shapes[][2] = {{8, 8}, {16, 16}, {32, 4}, {64, 1}};
+    for (const auto& shape : shapes) {
+        for (bool morton : {false, true}) {
+            DispatchConfig config;
+            config.localSizeX = shape[0];
+            config.localSizeY = shape[1];
+            config.mortonOrder = morton;
+            candidates.push_back(config);
+        }
+    }
+    return candidates;
+}
+
+DispatchConfig DispatchAutotuner::tune(Renderer& renderer) {
+    const std::string key = cacheKey(renderer);
+
+    DispatchConfig cached;
+    if (loadCached(key, cached)) {
+        try {
+            renderer.setDispatchConfig(cached);
+            return cached;
+        } catch (const std::exception& e) {
+            std::cerr << "Cached dispatch config " << cached.toString()
+                      << " rejected, retuning: " << e.what() << std::endl;
+        }
+    }
+
+    GLint maxInvocations = 0;
+    glGetIntegerv(GL_MAX_COMPUTE_WORK_GROUP_INVOCATIONS, &maxInvocations);
+
+    DispatchConfig best = renderer.getDispatchConfig();
+    double bestTime = std::numeric_limits<double>::max();
+    for (const auto& candidate : defaultCandidates()) {
+        if (candidate.localSizeX * candidate.localSizeY > maxInvocations) {
+            continue;
+        }
+        try {
+            renderer.setDispatchConfig(candidate);
+        } catch (const std::exception& e) {
+            std::cerr << "Skipping dispatch config " << candidate.toString() << ": " << e.what() << std::endl;
+            continue;
+        }
+
+        double time = measure(renderer);
+        std::cout << "Dispatch config " << candidate.toString() << ": " << time << " ms" << std::endl;
+        if (time < bestTime) {
+            bestTime = time;
+            best = candidate;
+        }
+    }
+
+    renderer.setDispatchConfig(best);
+    storeCached(key, best);
+    std::cout << "Selected dispatch config " << best.toString() << std::endl;
+    return best;
+}
+
+std::string DispatchAutotuner::cacheKey(const Renderer& renderer) {
+    // The best config differs between tracer variants, e.g. with and without binning
+    std::string key = glString(GL_VENDOR) + "|" + glString(GL_RENDERER) + "|" + glString(GL_VERSION) + "|" +
+                      renderer.getTracerVariant();
+    // Keep the key on one line of the cache file
+    std::replace(key.begin(), key.end(), '\t', ' ');
+    std::replace(key.begin(), key.end(), '\n', ' ');
+    return key;
+}
+
+bool DispatchAutotuner::loadCached(const std::string& key, DispatchConfig& config) const {
+    std::ifstream file(cachePath);
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t tab = line.rfind('\t');
+        if (tab != std::string::npos && line.compare(0, tab, key) == 0 && tab == key.size()) {
+            return DispatchConfig::parse(line.substr(tab + 1), config);
+        }
+    }
+    return false;
+}
+
+void DispatchAutotuner::storeCached(const std::string& key, const DispatchConfig& config) const {
+    // Rewrite the file, replacing any previous entry for this device
+    std::vector<std::string> lines;
+    {
+        std::ifstream file(cachePath);
+        std::string line;
+        while (std::getline(file, line)) {
+            if (line.compare(0, key.size() + 1, key + "\t") != 0) {
+                lines.push_back(line);
+            }
+        }
+    }
+    lines.push_back(key + "\t" + config.toString());
+
+    std::ofstream file(cachePath, std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "Could not write autotune cache: " << cachePath << std::endl;
+        return;
+    }
+    for (const auto& line : lines) {
+        file << line << "\n";
+    }
+}
+
+double DispatchAutotuner::measure(Renderer& renderer) {
+    for (int i = 0; i < WARMUP_FRAMES; i++) {
+        renderer.render();
+    }
+
+    GLuint queries[TIMED_FRAMES];
+    glGenQueries(TIMED_FRAMES, queries);
+    for (int i = 0; i < TIMED_FRAMES; i++) {
+        glBeginQuery(GL_TIME_ELAPSED, queries[i]);
+        renderer.render();
+        glEndQuery(GL_TIME_ELAPSED);
+    }
+
+    std::vector<double> times;
+    for (int i = 0; i < TIMED_FRAMES; i++) {
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(queries[i], GL_QUERY_RESULT, &elapsed);
+        times.push_back(elapsed / 1.0e6);
+    }
+    glDeleteQueries(TIMED_FRAMES, queries);
+
+    // Median is robust against a stray slow frame
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include "core/renderer.hpp"
+#include <string>
+#include <vector>
+
+// Picks the fastest DispatchConfig for the current device. Candidates are
+// compiled in turn and timed with GL_TIME_ELAPSED queries on the scene as
+// currently set up; the winner is cached per GL vendor/renderer/version and
+// tracer variant (features and output format) so later launches skip the
+// search.
+class DispatchAutotuner {
+public:
+    explicit DispatchAutotuner(std::string cachePath);
+
+    // Applies the best configuration to the renderer and returns it
+    DispatchConfig tune(Renderer& renderer);
+
+    static std::vector<DispatchConfig> defaultCandidates();
+
+private:
+    std::string cachePath;
+
+    static std::string cacheKey(const Renderer& renderer);
+    bool loadCached(const std::string& key, DispatchConfig& config) const;
+    void storeCached(const std::string& key, const DispatchConfig& config) const;
+    static double measure(Renderer& renderer);
+};
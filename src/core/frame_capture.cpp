@@ -0,0 +1,234 @@
+#include "frame_capture.hpp"
+#include "memory_tracker.hpp"
+#include "image_writer.hpp"
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+FrameCapture::FrameCapture(int w, int h, const CaptureSettings& captureSettings)
+    : width(w), height(h), settings(captureSettings) {
+    if (settings.ringSize < 1) settings.ringSize = 1;
+    if (settings.maxQueuedFrames < 1) settings.maxQueuedFrames = 1;
+
+    readType = settings.format == CaptureFormat::EXR ? GL_HALF_FLOAT : GL_UNSIGNED_BYTE;
+    size_t bytesPerPixel = settings.format == CaptureFormat::EXR ? 8 : 4;
+    frameBytes = static_cast<size_t>(width) * height * bytesPerPixel;
+
+    if (settings.format == CaptureFormat::RawVideo) {
+        rawStream.open(settings.outputPath, std::ios::binary);
+        if (!rawStream.is_open()) {
+            throw std::runtime_error("Failed to open capture stream: " + settings.outputPath);
+        }
+    }
+
+    ring.resize(settings.ringSize);
+    for (auto& slot : ring) {
+        glGenBuffers(1, &slot.pbo);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+        glBufferData(GL_PIXEL_PACK_BUFFER, frameBytes, nullptr, GL_STREAM_READ);
+        MemoryTracker::get().trackBuffer(slot.pbo, frameBytes, MemoryCategory::Capture);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    encoder = std::thread(&FrameCapture::encoderLoop, this);
+}
+
+FrameCapture::~FrameCapture() {
+    try {
+        finish();
+    } catch (const std::exception& e) {
+        std::cerr << "Frame capture: " << e.what() << std::endl;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+    }
+    queueNotEmpty.notify_all();
+    encoder.join();
+
+    for (auto& slot : ring) {
+        if (slot.fence) glDeleteSync(slot.fence);
+        MemoryTracker::get().releaseBuffer(slot.pbo);
+        glDeleteBuffers(1, &slot.pbo);
+    }
+    glDeleteFramebuffers(1, &layerFramebuffer);
+
+    if (settings.format == CaptureFormat::RawVideo) {
+        std::cout << "Captured " << capturedFrames << " frames to " << settings.outputPath
+                  << " (ffmpeg -f rawvideo -pix_fmt rgba -s " << width << "x" << height
+                  << " -i " << settings.outputPath << " ...)" << std::endl;
+    }
+}
+
+bool FrameCapture::parseFormat(const std::string& name, CaptureFormat& format) {
+    if (name == "png") {
+        format = CaptureFormat::PNG;
+    } else if (name == "exr") {
+        format = CaptureFormat::EXR;
+    } else if (name == "raw") {
+        format = CaptureFormat::RawVideo;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void FrameCapture::capture(GLuint texture, int layer) {
+    // Every PBO still in flight: wait for the oldest download
+    if (slotsInFlight == ring.size()) {
+        collect(true);
+    }
+
+    Slot& slot = ring[nextSlot];
+    slot.frameIndex = nextFrameIndex++;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    if (layer < 0) {
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, readType, nullptr);
+    } else {
+        if (layerFramebuffer == 0) {
+            glGenFramebuffers(1, &layerFramebuffer);
+        }
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, layerFramebuffer);
+        glFramebufferTextureLayer(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, texture, 0, layer);
+        glReadBuffer(GL_COLOR_ATTACHMENT0);
+        glReadPixels(0, 0, width, height, GL_RGBA, readType, nullptr);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    nextSlot = (nextSlot + 1) % ring.size();
+    slotsInFlight++;
+
+    // Pick up whatever has already landed without blocking
+    collect(false);
+}
+
+void FrameCapture::finish() {
+    while (slotsInFlight > 0) {
+        collect(true);
+    }
+
+    std::unique_lock<std::mutex> lock(queueMutex);
+    queueNotFull.wait(lock, [this] { return queue.empty() && !encoding; });
+}
+
+void FrameCapture::collect(bool wait) {
+    while (slotsInFlight > 0) {
+        Slot& slot = ring[oldestSlot];
+        GLenum status = glClientWaitSync(slot.fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0,
+                                         wait ? GL_TIMEOUT_IGNORED : 0);
+        if (status == GL_TIMEOUT_EXPIRED) {
+            return;
+        }
+        if (status == GL_WAIT_FAILED) {
+            throw std::runtime_error("Frame capture fence wait failed");
+        }
+
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+        handOff(slot);
+
+        oldestSlot = (oldestSlot + 1) % ring.size();
+        slotsInFlight--;
+        // A blocking collect only needs to free one slot
+        wait = false;
+    }
+}
+
+void FrameCapture::handOff(Slot& slot) {
+    std::vector<uint8_t> pixels;
+    {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        if (queue.size() >= settings.maxQueuedFrames) {
+            if (settings.dropWhenBusy) {
+                droppedFrames++;
+                return;
+            }
+            queueNotFull.wait(lock, [this] { return queue.size() < settings.maxQueuedFrames; });
+        }
+        if (!freeBuffers.empty()) {
+            pixels = std::move(freeBuffers.back());
+            freeBuffers.pop_back();
+        }
+    }
+    pixels.resize(frameBytes);
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+    const void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, frameBytes, GL_MAP_READ_BIT);
+    if (mapped) {
+        std::memcpy(pixels.data(), mapped, frameBytes);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (!mapped) {
+        throw std::runtime_error("Failed to map capture buffer");
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        queue.push_back({slot.frameIndex, std::move(pixels)});
+    }
+    queueNotEmpty.notify_one();
+    capturedFrames++;
+}
+
+void FrameCapture::encoderLoop() {
+    for (;;) {
+        Frame frame;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueNotEmpty.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (queue.empty()) {
+                return;
+            }
+            frame = std::move(queue.front());
+            queue.pop_front();
+            encoding = true;
+        }
+
+        try {
+            encode(frame);
+        } catch (const std::exception& e) {
+            std::cerr << "Frame capture: " << e.what() << std::endl;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            freeBuffers.push_back(std::move(frame.pixels));
+            encoding = false;
+        }
+        queueNotFull.notify_all();
+    }
+}
+
+void FrameCapture::encode(const Frame& frame) {
+    // GL rows are bottom-up, every output format wants them top-down
+    const size_t rowBytes = frameBytes / height;
+    flipped.resize(frameBytes);
+    for (int y = 0; y < height; y++) {
+        std::memcpy(flipped.data() + y * rowBytes,
+                    frame.pixels.data() + (height - 1 - y) * rowBytes, rowBytes);
+    }
+
+    if (settings.format == CaptureFormat::RawVideo) {
+        rawStream.write(reinterpret_cast<const char*>(flipped.data()), flipped.size());
+        return;
+    }
+
+    std::ostringstream path;
+    path << settings.outputPath << "_" << std::setw(6) << std::setfill('0') << frame.index
+         << (settings.format == CaptureFormat::EXR ? ".exr" : ".png");
+
+    if (settings.format == CaptureFormat::EXR) {
+        writeExr(path.str(), width, height, reinterpret_cast<const uint16_t*>(flipped.data()));
+    } else {
+        writePng(path.str(), width, height, flipped.data());
+    }
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include <glad/glad.h>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class CaptureFormat {
+    PNG,      // numbered 8-bit PNG sequence
+    EXR,      // numbered half-float OpenEXR sequence
+    RawVideo  // single stream of RGBA8 frames, e.g. for ffmpeg -f rawvideo
+};
+
+struct CaptureSettings {
+    CaptureFormat format{CaptureFormat::PNG};
+    std::string outputPath{"capture"}; // prefix for sequences, file name for raw video
+    int ringSize{3};                   // pixel buffer objects in flight
+    size_t maxQueuedFrames{8};         // encoder backlog before back-pressure kicks in
+    bool dropWhenBusy{false};          // drop frames instead of blocking on a slow disk
+};
+
+// Asynchronous readback of the renderer output. Each capture() issues a
+// texture download into the next pixel buffer object of a ring and fences
+// it; completed downloads are copied out and handed to an encoder thread.
+// The render loop only blocks when every PBO is still in flight or, unless
+// frames may be dropped, when the encoder backlog is full.
+class FrameCapture {
+public:
+    FrameCapture(int width, int height, const CaptureSettings& settings);
+    ~FrameCapture();
+
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+
+    // A non-negative layer reads one layer of a 2D array texture
+    void capture(GLuint texture, int layer = -1);
+    // Waits for all readbacks and encodes everything still queued
+    void finish();
+
+    uint64_t getCapturedFrames() const { return capturedFrames; }
+    uint64_t getDroppedFrames() const { return droppedFrames; }
+    static bool parseFormat(const std::string& name, CaptureFormat& format);
+
+private:
+    struct Slot {
+        GLuint pbo{0};
+        GLsync fence{nullptr};
+        uint64_t frameIndex{0};
+    };
+    struct Frame {
+        uint64_t index;
+        std::vector<uint8_t> pixels;
+    };
+
+    int width, height;
+    CaptureSettings settings;
+    size_t frameBytes;
+    GLenum readType;
+
+    std::vector<Slot> ring;
+    GLuint layerFramebuffer{0};
+    size_t nextSlot{0};
+    size_t oldestSlot{0};
+    size_t slotsInFlight{0};
+    uint64_t nextFrameIndex{0};
+    uint64_t capturedFrames{0};
+    uint64_t droppedFrames{0};
+
+    std::thread encoder;
+    std::mutex queueMutex;
+    std::condition_variable queueNotEmpty;
+    std::condition_variable queueNotFull;
+    std::deque<Frame> queue;
+    std::vector<std::vector<uint8_t>> freeBuffers;
+    bool encoding{false}; // the encoder holds a frame taken off the queue
+    bool stopping{false};
+    std::ofstream rawStream;
+    std::vector<uint8_t> flipped; // encoder thread only, reused across frames
+
+    void collect(bool wait);
+    void handOff(Slot& slot);
+    void encoderLoop();
+    void encode(const Frame& frame);
+};
@@ -0,0 +1,35 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstdint>
+
+// CPU mirror of the std140 FrameConstants block in
+// shaders/common/frame_constants.glsl. Each vec3 is followed by a scalar so
+// the layouts agree without explicit padding.
+struct FrameConstants {
+    glm::vec3 cameraPosition;
+    float rustLevel;
+    glm::vec3 cameraFront;
+    float age;
+    glm::vec3 cameraUp;
+    float frameWidth;
+    glm::vec3 lightDirection;
+    float lightIntensity;
+    float moisture;
+    float time;
+    int32_t numObjects;
+    float lodScale;
+};
+
+static_assert(sizeof(FrameConstants) == 80, "FrameConstants must match the std140 layout");
+
+// Camera pushed just before a megakernel dispatch when late latching, see
+// LatchedCamera in shaders/common/frame_constants.glsl
+struct LatchedCamera {
+    glm::vec4 position;
+    glm::vec4 front;
+    glm::vec4 up;
+};
+
+// Uniform block binding points
+const unsigned FRAME_CONSTANTS_BINDING = 0;
+const unsigned LATCHED_CAMERA_BINDING = 1;
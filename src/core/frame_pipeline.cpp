@@ -0,0 +1,102 @@
+#include "frame_pipeline.hpp"
+#include <utility>
+
+FramePipeline::FramePipeline(int frames, SimulateFunction simulateFunction)
+    : framesInFlight(frames > 1 ? frames : 1), simulate(std::move(simulateFunction)) {
+    if (framesInFlight > 1) {
+        simulationThread = std::thread(&FramePipeline::simulationLoop, this);
+    }
+}
+
+FramePipeline::~FramePipeline() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    inputAvailable.notify_all();
+    if (simulationThread.joinable()) {
+        simulationThread.join();
+    }
+}
+
+void FramePipeline::runSimulation(const InputFrame& input, FrameSnapshot& snapshot, uint64_t frameIndex) {
+    simulate(input, snapshot);
+    snapshot.frameIndex = frameIndex;
+    snapshot.input = input;
+}
+
+void FramePipeline::submit(const InputFrame& input) {
+    if (framesInFlight == 1) {
+        FrameSnapshot snapshot;
+        if (!spareSnapshots.empty()) {
+            snapshot = std::move(spareSnapshots.back());
+            spareSnapshots.pop_back();
+        }
+        runSimulation(input, snapshot, submittedFrames++);
+        finishedSnapshots.push_back(std::move(snapshot));
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pendingInputs.push_back(input);
+        submittedFrames++;
+    }
+    inputAvailable.notify_one();
+}
+
+bool FramePipeline::acquire(FrameSnapshot& snapshot) {
+    std::unique_lock<std::mutex> lock(mutex, std::defer_lock);
+    if (framesInFlight > 1) {
+        lock.lock();
+    }
+    // While filling, the render thread has nothing to show yet; afterwards
+    // every submit is matched by exactly one acquire
+    if (submittedFrames - acquiredFrames < static_cast<uint64_t>(framesInFlight)) {
+        return false;
+    }
+    if (framesInFlight > 1) {
+        snapshotAvailable.wait(lock, [this] { return !finishedSnapshots.empty() || simulationError; });
+        if (simulationError) {
+            std::rethrow_exception(simulationError);
+        }
+    }
+
+    std::swap(snapshot, finishedSnapshots.front());
+    spareSnapshots.push_back(std::move(finishedSnapshots.front()));
+    finishedSnapshots.pop_front();
+    acquiredFrames++;
+    return true;
+}
+
+void FramePipeline::simulationLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    uint64_t frameIndex = 0;
+    while (true) {
+        inputAvailable.wait(lock, [this] { return stopping || !pendingInputs.empty(); });
+        if (stopping) {
+            return;
+        }
+        InputFrame input = pendingInputs.front();
+        pendingInputs.pop_front();
+        FrameSnapshot snapshot;
+        if (!spareSnapshots.empty()) {
+            snapshot = std::move(spareSnapshots.back());
+            spareSnapshots.pop_back();
+        }
+
+        lock.unlock();
+        try {
+            runSimulation(input, snapshot, frameIndex++);
+        } catch (...) {
+            lock.lock();
+            simulationError = std::current_exception();
+            snapshotAvailable.notify_all();
+            return;
+        }
+        lock.lock();
+
+        finishedSnapshots.push_back(std::move(snapshot));
+        snapshotAvailable.notify_one();
+    }
+}
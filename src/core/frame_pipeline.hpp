@@ -0,0 +1,55 @@
+#pragma once
+#include "core/frame_snapshot.hpp"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Runs the simulation on its own thread, up to framesInFlight - 1 frames
+// ahead of the frame being rendered. The render thread submits one input
+// per frame and renders the snapshots that come back, in order. With one
+// frame in flight the simulation runs inline on the caller's thread.
+class FramePipeline {
+public:
+    // Advances the simulation by one input and fills the snapshot
+    using SimulateFunction = std::function<void(const InputFrame& input, FrameSnapshot& snapshot)>;
+
+    FramePipeline(int framesInFlight, SimulateFunction simulate);
+    ~FramePipeline();
+
+    FramePipeline(const FramePipeline&) = delete;
+    FramePipeline& operator=(const FramePipeline&) = delete;
+
+    void submit(const InputFrame& input);
+    // Swaps the oldest finished snapshot into `snapshot`, waiting for it if
+    // the pipeline is full. Returns false while the pipeline is still
+    // filling up. Rethrows anything the simulation threw.
+    bool acquire(FrameSnapshot& snapshot);
+
+    int getFramesInFlight() const { return framesInFlight; }
+
+private:
+    int framesInFlight;
+    SimulateFunction simulate;
+
+    std::mutex mutex;
+    std::condition_variable inputAvailable;
+    std::condition_variable snapshotAvailable;
+    std::deque<InputFrame> pendingInputs;
+    std::deque<FrameSnapshot> finishedSnapshots;
+    // Snapshots handed back by acquire, reused so their object vectors keep
+    // their capacity
+    std::vector<FrameSnapshot> spareSnapshots;
+    uint64_t submittedFrames{0};
+    uint64_t acquiredFrames{0};
+    bool stopping{false};
+    std::exception_ptr simulationError;
+    std::thread simulationThread;
+
+    void simulationLoop();
+    void runSimulation(const InputFrame& input, FrameSnapshot& snapshot, uint64_t frameIndex);
+};
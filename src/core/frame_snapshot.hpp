@@ -0,0 +1,21 @@
+#pragma once
+#include "core/frame_constants.hpp"
+#include "core/gpu_object.hpp"
+#include "core/input_recorder.hpp"
+#include "core/water_simulation.hpp"
+#include <cstdint>
+#include <vector>
+
+// Immutable copy of everything a frame needs for rendering, taken at the end
+// of its simulation step. Rendering from a snapshot never touches live
+// simulation state, so the next frame can be simulated concurrently.
+struct FrameSnapshot {
+    uint64_t frameIndex{0};
+    InputFrame input;              // what the frame was simulated from
+    FrameConstants constants{};
+    std::vector<GpuObject> objects;
+    WaterForcing water;            // rain and splashes since the last snapshot
+    // Water state after this frame's step, only set by Renderer::stepWater
+    // for renderers that see frames out of order; they load it instead
+    std::vector<uint8_t> waterState;
+};
@@ -0,0 +1,40 @@
+#include "gpu_object.hpp"
+#include <glm/gtc/packing.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+namespace {
+
+// Age at which an object renders as fully aged; the default environment
+// ages objects by about 4.2 units a second, so this is some ten minutes
+const float FULL_AGE = 2500.0f;
+
+uint32_t toUnorm8(float value) {
+    return static_cast<uint32_t>(glm::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+} // namespace
+
+GpuMaterial getDefaultMaterial(ObjectType type) {
+    switch (type) {
+        case ObjectType::SPHERE: return GpuMaterial::Steel;
+        case ObjectType::RECTANGLE: return GpuMaterial::Paint;
+        case ObjectType::GROUND: return GpuMaterial::Ground;
+        case ObjectType::WALL: return GpuMaterial::Brick;
+    }
+    return GpuMaterial::Sky;
+}
+
+void packGpuObject(const SceneObject& object, GpuObject& out) {
+    out.position = object.position;
+    out.info = static_cast<uint32_t>(object.type)
+        | static_cast<uint32_t>(getDefaultMaterial(object.type)) << 8
+        | toUnorm8(object.agingProps.currentAge / FULL_AGE) << 16
+        | toUnorm8(object.rustLevel) << 24;
+
+    // rotation holds Euler angles in radians
+    glm::quat q = glm::normalize(glm::quat(object.rotation));
+    out.rotation[0] = glm::packSnorm2x16(glm::vec2(q.x, q.y));
+    out.rotation[1] = glm::packSnorm2x16(glm::vec2(q.z, q.w));
+    out.scaleXY = glm::packHalf2x16(glm::vec2(object.scale.x, object.scale.y));
+    out.scaleZ = glm::packHalf2x16(glm::vec2(object.scale.z, 0.0f));
+}
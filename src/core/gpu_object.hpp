@@ -0,0 +1,35 @@
+#pragma once
+#include "core/scene_object.hpp"
+#include <glm/glm.hpp>
+#include <cstdint>
+
+// Shading material of an object, matching the MATERIAL_* constants in
+// shaders/common/objects.glsl. The painting's frame/canvas split is decided
+// per hit, so rectangles report MATERIAL_PAINT.
+enum class GpuMaterial : uint8_t {
+    Sky,
+    Steel,
+    Wood,
+    Paint,
+    Brick,
+    Ground
+};
+
+// One object as the shaders see it (std430 ObjectRecord, 32 bytes):
+//   position    world-space center
+//   info        type | material << 8 | age << 16 | rust << 24 (unorm8 each)
+//   rotation    orientation quaternion xy, zw as snorm16 pairs
+//   scaleXY     half-float scale x, y
+//   scaleZ      half-float scale z, upper 16 bits reserved
+struct GpuObject {
+    glm::vec3 position;
+    uint32_t info;
+    uint32_t rotation[2];
+    uint32_t scaleXY;
+    uint32_t scaleZ;
+};
+static_assert(sizeof(GpuObject) == 32, "GpuObject must match the std430 ObjectRecord layout");
+
+GpuMaterial getDefaultMaterial(ObjectType type);
+// Quantizes the object's transform and aging state into `out`
+void packGpuObject(const SceneObject& object, GpuObject& out);
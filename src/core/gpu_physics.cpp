@@ -0,0 +1,201 @@
+#include "gpu_physics.hpp"
+#include "memory_tracker.hpp"
+#include "renderer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace {
+
+// Matches DebrisBody in shaders/debris/debris.glsl
+struct DebrisBody {
+    glm::vec4 positionRadius;
+    glm::vec4 velocity;
+};
+
+// The room from core/physics.cpp with some margin; bodies that leave
+// through the open front share the border cells
+const glm::vec3 GRID_MIN(-6.0f, -1.5f, -6.0f);
+const glm::vec3 GRID_MAX(6.0f, 6.5f, 6.0f);
+const int MAX_GRID_CELLS_PER_AXIS = 64;
+
+// impactCount and padding ahead of the vec4 impacts
+const size_t IMPACT_HEADER = sizeof(GLuint) * 4;
+const size_t IMPACT_BUFFER_SIZE = IMPACT_HEADER + sizeof(glm::vec4) * GpuPhysics::MAX_IMPACTS;
+
+GLuint createBuffer(GLenum target, size_t size, const void* data, GLenum usage) {
+    GLuint buffer;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(target, buffer);
+    glBufferData(target, size, data, usage);
+    glBindBuffer(target, 0);
+    MemoryTracker::get().trackBuffer(buffer, size, MemoryCategory::Debris);
+    return buffer;
+}
+
+} // namespace
+
+GpuPhysics::GpuPhysics(int count, float radius) : bodyCount(std::max(count, 0)) {
+    const std::vector<std::string> defines = {
+        "MAX_CELL_BODIES " + std::to_string(MAX_CELL_BODIES),
+        "MAX_DEBRIS_IMPACTS " + std::to_string(MAX_IMPACTS),
+    };
+    insertProgram = Renderer::createComputeProgram("shaders/debris/insert.comp", defines);
+    stepProgram = Renderer::createComputeProgram("shaders/debris/step.comp", defines);
+    packProgram = Renderer::createComputeProgram("shaders/debris/pack.comp", defines);
+    insertLocations = getGridLocations(insertProgram);
+    stepLocations = getGridLocations(stepProgram);
+    timeStepLoc = glGetUniformLocation(stepProgram, "timeStep");
+    sceneObjectCountLoc = glGetUniformLocation(stepProgram, "sceneObjectCount");
+    packBodyCountLoc = glGetUniformLocation(packProgram, "bodyCount");
+    firstObjectLoc = glGetUniformLocation(packProgram, "firstObject");
+
+    // Cells must span a body diameter for the 27-cell neighbourhood to
+    // find every contact
+    const glm::vec3 extent = GRID_MAX - GRID_MIN;
+    const float largestExtent = std::max(extent.x, std::max(extent.y, extent.z));
+    gridOrigin = GRID_MIN;
+    cellSize = std::max(2.0f * radius, largestExtent / MAX_GRID_CELLS_PER_AXIS);
+    gridSize = glm::max(glm::ivec3(glm::ceil(extent / cellSize)), glm::ivec3(1));
+    cellCount = static_cast<size_t>(gridSize.x) * gridSize.y * gridSize.z;
+
+    // The only time body state crosses the bus
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::vector<DebrisBody> bodies(static_cast<size_t>(bodyCount));
+    for (auto& body : bodies) {
+        glm::vec3 position(-4.5f + 9.0f * unit(random), 4.5f * unit(random), -4.5f + 7.5f * unit(random));
+        glm::vec3 velocity(unit(random) - 0.5f, 0.0f, unit(random) - 0.5f);
+        body.positionRadius = glm::vec4(position, radius);
+        body.velocity = glm::vec4(velocity, 0.0f);
+    }
+    const size_t stateSize = std::max<size_t>(bodies.size(), 1) * sizeof(DebrisBody);
+    stateBuffers[0] = createBuffer(GL_SHADER_STORAGE_BUFFER, stateSize, bodies.data(), GL_DYNAMIC_COPY);
+    stateBuffers[1] = createBuffer(GL_SHADER_STORAGE_BUFFER, stateSize, bodies.data(), GL_DYNAMIC_COPY);
+    gridBuffer = createBuffer(GL_SHADER_STORAGE_BUFFER, cellCount * (1 + MAX_CELL_BODIES) * sizeof(GLuint),
+                              nullptr, GL_DYNAMIC_COPY);
+    const std::vector<unsigned char> zeros(IMPACT_BUFFER_SIZE, 0);
+    impactBuffer = createBuffer(GL_SHADER_STORAGE_BUFFER, IMPACT_BUFFER_SIZE, zeros.data(), GL_DYNAMIC_COPY);
+    readbackBuffer = createBuffer(GL_COPY_WRITE_BUFFER, IMPACT_BUFFER_SIZE, nullptr, GL_STREAM_READ);
+}
+
+GpuPhysics::~GpuPhysics() {
+    if (readbackFence) glDeleteSync(readbackFence);
+    glDeleteProgram(insertProgram);
+    glDeleteProgram(stepProgram);
+    glDeleteProgram(packProgram);
+    for (GLuint buffer : {stateBuffers[0], stateBuffers[1], gridBuffer, impactBuffer, readbackBuffer}) {
+        MemoryTracker::get().releaseBuffer(buffer);
+    }
+    glDeleteBuffers(2, stateBuffers);
+    glDeleteBuffers(1, &gridBuffer);
+    glDeleteBuffers(1, &impactBuffer);
+    glDeleteBuffers(1, &readbackBuffer);
+}
+
+void GpuPhysics::step(float deltaTime, int sceneObjectCount) {
+    if (bodyCount == 0) {
+        return;
+    }
+    const GLuint groups = static_cast<GLuint>((bodyCount + 63) / 64);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, GRID_BINDING, gridBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, IMPACT_BINDING, impactBuffer);
+
+    bool stepped = false;
+    accumulator = std::min(accumulator + deltaTime, TIMESTEP * MAX_STEPS_PER_FRAME);
+    while (accumulator >= TIMESTEP) {
+        const int next = 1 - current;
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, STATE_IN_BINDING, stateBuffers[current]);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, STATE_OUT_BINDING, stateBuffers[next]);
+
+        // Only the per-cell counts need clearing
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, gridBuffer);
+        glClearBufferSubData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, 0, cellCount * sizeof(GLuint), GL_RED_INTEGER,
+                             GL_UNSIGNED_INT, nullptr);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+        glUseProgram(insertProgram);
+        setGridUniforms(insertLocations);
+        glDispatchCompute(groups, 1, 1);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+        glUseProgram(stepProgram);
+        setGridUniforms(stepLocations);
+        glUniform1f(timeStepLoc, TIMESTEP);
+        glUniform1i(sceneObjectCountLoc, sceneObjectCount);
+        glDispatchCompute(groups, 1, 1);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+        current = next;
+        accumulator -= TIMESTEP;
+        stepped = true;
+    }
+
+    // Ship this frame's impacts unless the previous copy is still in flight;
+    // until then they keep accumulating on the GPU
+    if (stepped && !readbackFence) {
+        glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+        glBindBuffer(GL_COPY_READ_BUFFER, impactBuffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, readbackBuffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, IMPACT_BUFFER_SIZE);
+        const GLuint zero = 0;
+        glBufferSubData(GL_COPY_READ_BUFFER, 0, sizeof(zero), &zero);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        readbackFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+}
+
+void GpuPhysics::writeObjects(int firstObject) {
+    if (bodyCount == 0) {
+        return;
+    }
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, STATE_IN_BINDING, stateBuffers[current]);
+    glUseProgram(packProgram);
+    glUniform1i(packBodyCountLoc, bodyCount);
+    glUniform1i(firstObjectLoc, firstObject);
+    glDispatchCompute(static_cast<GLuint>((bodyCount + 63) / 64), 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+void GpuPhysics::collectImpacts(std::vector<WaterImpact>& impacts) {
+    if (!readbackFence) {
+        return;
+    }
+    GLenum status = glClientWaitSync(readbackFence, 0, 0);
+    if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+        return;
+    }
+    glDeleteSync(readbackFence);
+    readbackFence = nullptr;
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, readbackBuffer);
+    const auto* data = static_cast<const unsigned char*>(
+        glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, IMPACT_BUFFER_SIZE, GL_MAP_READ_BIT));
+    if (data) {
+        GLuint count = *reinterpret_cast<const GLuint*>(data);
+        const auto* reported = reinterpret_cast<const glm::vec4*>(data + IMPACT_HEADER);
+        for (GLuint i = 0; i < std::min<GLuint>(count, MAX_IMPACTS); i++) {
+            const glm::vec4& impact = reported[i];
+            impacts.push_back({glm::vec2(impact.x, impact.z), 0.15f, std::min(impact.w * 0.02f, 0.2f)});
+        }
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+GpuPhysics::GridLocations GpuPhysics::getGridLocations(GLuint program) {
+    GridLocations locations;
+    locations.bodyCount = glGetUniformLocation(program, "bodyCount");
+    locations.gridOrigin = glGetUniformLocation(program, "gridOrigin");
+    locations.cellSize = glGetUniformLocation(program, "cellSize");
+    locations.gridSize = glGetUniformLocation(program, "gridSize");
+    return locations;
+}
+
+void GpuPhysics::setGridUniforms(const GridLocations& locations) const {
+    glUniform1i(locations.bodyCount, bodyCount);
+    glUniform3f(locations.gridOrigin, gridOrigin.x, gridOrigin.y, gridOrigin.z);
+    glUniform1f(locations.cellSize, cellSize);
+    glUniform3i(locations.gridSize, gridSize.x, gridSize.y, gridSize.z);
+}
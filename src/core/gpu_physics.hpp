@@ -0,0 +1,75 @@
+#pragma once
+#include "core/water_simulation.hpp"
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <vector>
+
+// Debris spheres simulated entirely on the GPU. Body state stays in two
+// storage buffers that are swapped every fixed step: a grid pass bins the
+// bodies, a step pass resolves sphere, scene sphere and room contacts and
+// integrates, and a pack pass writes each body as an object record into
+// the render object buffer after the scene's own objects. Only hard ground
+// impacts come back, through a small asynchronous readback.
+class GpuPhysics {
+public:
+    static constexpr float TIMESTEP = 1.0f / 120.0f;
+    static const int MAX_CELL_BODIES = 8;    // matches debris.glsl
+    static const int MAX_IMPACTS = 8;        // reported per readback, matches step.comp
+
+    // Drops `bodyCount` spheres of `radius` at random over the room
+    GpuPhysics(int bodyCount, float radius);
+    ~GpuPhysics();
+
+    GpuPhysics(const GpuPhysics&) = delete;
+    GpuPhysics& operator=(const GpuPhysics&) = delete;
+
+    // Advances by `deltaTime` in fixed steps. The first `sceneObjectCount`
+    // records of the bound object buffer must hold this frame's scene.
+    void step(float deltaTime, int sceneObjectCount);
+    // Writes the bodies into the bound object buffer from `firstObject` on;
+    // it needs room for getBodyCount() records there
+    void writeObjects(int firstObject);
+    // Appends ground impacts from a finished readback, never waits
+    void collectImpacts(std::vector<WaterImpact>& impacts);
+    int getBodyCount() const { return bodyCount; }
+
+private:
+    static const int MAX_STEPS_PER_FRAME = 4;
+    static const GLuint STATE_IN_BINDING = 11;
+    static const GLuint STATE_OUT_BINDING = 12;
+    static const GLuint GRID_BINDING = 13;
+    static const GLuint IMPACT_BINDING = 14;
+
+    int bodyCount;
+    GLuint stateBuffers[2]{};
+    int current{0};
+    GLuint gridBuffer{0};
+    GLuint impactBuffer{0};
+    GLuint readbackBuffer{0};
+    GLsync readbackFence{nullptr};
+    GLuint insertProgram{0};
+    GLuint stepProgram{0};
+    GLuint packProgram{0};
+
+    // Uniform locations, resolved once in the constructor
+    struct GridLocations {
+        GLint bodyCount{-1};
+        GLint gridOrigin{-1};
+        GLint cellSize{-1};
+        GLint gridSize{-1};
+    };
+    GridLocations insertLocations;
+    GridLocations stepLocations;
+    GLint timeStepLoc{-1};
+    GLint sceneObjectCountLoc{-1};
+    GLint packBodyCountLoc{-1};
+    GLint firstObjectLoc{-1};
+    glm::vec3 gridOrigin;
+    float cellSize;
+    glm::ivec3 gridSize;
+    size_t cellCount;
+    float accumulator{0.0f};
+
+    static GridLocations getGridLocations(GLuint program);
+    void setGridUniforms(const GridLocations& locations) const;
+};
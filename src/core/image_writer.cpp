@@ -0,0 +1,216 @@
+#include "image_writer.hpp"
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+const std::array<uint32_t, 256>& crcTable() {
+    static const std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> t{};
+        for (uint32_t n = 0; n < 256; n++) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            t[n] = c;
+        }
+        return t;
+    }();
+    return table;
+}
+
+uint32_t crc32(const uint8_t* data, size_t size, uint32_t crc = 0xFFFFFFFFu) {
+    const auto& table = crcTable();
+    for (size_t i = 0; i < size; i++) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+void putBE32(std::vector<uint8_t>& out, uint32_t v) {
+    out.push_back(static_cast<uint8_t>(v >> 24));
+    out.push_back(static_cast<uint8_t>(v >> 16));
+    out.push_back(static_cast<uint8_t>(v >> 8));
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+template <typename T>
+void putLE(std::vector<uint8_t>& out, T v) {
+    for (size_t i = 0; i < sizeof(T); i++) {
+        out.push_back(static_cast<uint8_t>(static_cast<uint64_t>(v) >> (8 * i)));
+    }
+}
+
+void putString(std::vector<uint8_t>& out, const char* s) {
+    while (*s) out.push_back(static_cast<uint8_t>(*s++));
+    out.push_back(0);
+}
+
+void writeChunk(std::ofstream& file, const char* type, const std::vector<uint8_t>& data) {
+    std::vector<uint8_t> header;
+    putBE32(header, static_cast<uint32_t>(data.size()));
+    file.write(reinterpret_cast<const char*>(header.data()), 4);
+
+    uint32_t crc = crc32(reinterpret_cast<const uint8_t*>(type), 4);
+    crc = crc32(data.data(), data.size(), crc) ^ 0xFFFFFFFFu;
+    file.write(type, 4);
+    file.write(reinterpret_cast<const char*>(data.data()), data.size());
+
+    std::vector<uint8_t> trailer;
+    putBE32(trailer, crc);
+    file.write(reinterpret_cast<const char*>(trailer.data()), 4);
+}
+
+std::ofstream openOutput(const std::string& path) {
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open image for writing: " + path);
+    }
+    return file;
+}
+
+} // namespace
+
+void writePng(const std::string& path, int width, int height, const uint8_t* rgba) {
+    const size_t rowBytes = static_cast<size_t>(width) * 4;
+
+    // Filtered scanlines: a zero filter byte followed by the raw row
+    std::vector<uint8_t> raw;
+    raw.reserve((rowBytes + 1) * height);
+    for (int y = 0; y < height; y++) {
+        raw.push_back(0);
+        raw.insert(raw.end(), rgba + y * rowBytes, rgba + (y + 1) * rowBytes);
+    }
+
+    // zlib stream built from stored deflate blocks
+    std::vector<uint8_t> idat;
+    idat.reserve(raw.size() + raw.size() / 65535 * 5 + 16);
+    idat.push_back(0x78);
+    idat.push_back(0x01);
+    const size_t maxBlock = 65535;
+    size_t offset = 0;
+    do {
+        size_t blockSize = std::min(maxBlock, raw.size() - offset);
+        bool last = offset + blockSize == raw.size();
+        idat.push_back(last ? 1 : 0);
+        putLE<uint16_t>(idat, static_cast<uint16_t>(blockSize));
+        putLE<uint16_t>(idat, static_cast<uint16_t>(~blockSize));
+        idat.insert(idat.end(), raw.begin() + offset, raw.begin() + offset + blockSize);
+        offset += blockSize;
+    } while (offset < raw.size());
+
+    uint32_t a = 1, b = 0;
+    for (uint8_t byte : raw) {
+        a = (a + byte) % 65521;
+        b = (b + a) % 65521;
+    }
+    putBE32(idat, (b << 16) | a);
+
+    std::vector<uint8_t> ihdr;
+    putBE32(ihdr, static_cast<uint32_t>(width));
+    putBE32(ihdr, static_cast<uint32_t>(height));
+    ihdr.push_back(8); // bit depth
+    ihdr.push_back(6); // colour type RGBA
+    ihdr.push_back(0); // compression
+    ihdr.push_back(0); // filter
+    ihdr.push_back(0); // interlace
+
+    std::ofstream file = openOutput(path);
+    static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    file.write(reinterpret_cast<const char*>(signature), sizeof(signature));
+    writeChunk(file, "IHDR", ihdr);
+    writeChunk(file, "IDAT", idat);
+    writeChunk(file, "IEND", {});
+}
+
+void writeExr(const std::string& path, int width, int height, const uint16_t* rgba) {
+    std::vector<uint8_t> header;
+    putLE<uint32_t>(header, 20000630); // magic
+    putLE<uint32_t>(header, 2);        // version 2, single-part scanline
+
+    // Channel list, alphabetical as the format requires
+    putString(header, "channels");
+    putString(header, "chlist");
+    putLE<uint32_t>(header, 4 * 18 + 1);
+    for (const char* name : {"A", "B", "G", "R"}) {
+        putString(header, name);
+        putLE<int32_t>(header, 1); // HALF
+        putLE<uint32_t>(header, 0); // pLinear + reserved
+        putLE<int32_t>(header, 1); // xSampling
+        putLE<int32_t>(header, 1); // ySampling
+    }
+    header.push_back(0);
+
+    putString(header, "compression");
+    putString(header, "compression");
+    putLE<uint32_t>(header, 1);
+    header.push_back(0); // NO_COMPRESSION
+
+    for (const char* window : {"dataWindow", "displayWindow"}) {
+        putString(header, window);
+        putString(header, "box2i");
+        putLE<uint32_t>(header, 16);
+        putLE<int32_t>(header, 0);
+        putLE<int32_t>(header, 0);
+        putLE<int32_t>(header, width - 1);
+        putLE<int32_t>(header, height - 1);
+    }
+
+    putString(header, "lineOrder");
+    putString(header, "lineOrder");
+    putLE<uint32_t>(header, 1);
+    header.push_back(0); // INCREASING_Y
+
+    const float one = 1.0f;
+    uint32_t oneBits;
+    std::copy_n(reinterpret_cast<const uint8_t*>(&one), 4, reinterpret_cast<uint8_t*>(&oneBits));
+
+    putString(header, "pixelAspectRatio");
+    putString(header, "float");
+    putLE<uint32_t>(header, 4);
+    putLE<uint32_t>(header, oneBits);
+
+    putString(header, "screenWindowCenter");
+    putString(header, "v2f");
+    putLE<uint32_t>(header, 8);
+    putLE<uint32_t>(header, 0);
+    putLE<uint32_t>(header, 0);
+
+    putString(header, "screenWindowWidth");
+    putString(header, "float");
+    putLE<uint32_t>(header, 4);
+    putLE<uint32_t>(header, oneBits);
+
+    header.push_back(0); // end of header
+
+    // Offset table: one uncompressed scanline per block
+    const uint32_t lineDataSize = static_cast<uint32_t>(width) * 4 * sizeof(uint16_t);
+    const uint64_t blockSize = 8 + lineDataSize;
+    uint64_t blockOffset = header.size() + static_cast<uint64_t>(height) * 8;
+    for (int y = 0; y < height; y++) {
+        putLE<uint64_t>(header, blockOffset + y * blockSize);
+    }
+
+    std::ofstream file = openOutput(path);
+    file.write(reinterpret_cast<const char*>(header.data()), header.size());
+
+    // Each block stores the channels planar, in A, B, G, R order
+    std::vector<uint8_t> block;
+    block.reserve(blockSize);
+    static const int channelOrder[4] = {3, 2, 1, 0};
+    for (int y = 0; y < height; y++) {
+        block.clear();
+        putLE<int32_t>(block, y);
+        putLE<uint32_t>(block, lineDataSize);
+        const uint16_t* row = rgba + static_cast<size_t>(y) * width * 4;
+        for (int channel : channelOrder) {
+            for (int x = 0; x < width; x++) {
+                putLE<uint16_t>(block, row[x * 4 + channel]);
+            }
+        }
+        file.write(reinterpret_cast<const char*>(block.data()), block.size());
+    }
+}
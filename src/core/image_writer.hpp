@@ -0,0 +1,14 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+// Minimal dependency-free image writers used by frame capture.
+// Pixel rows are expected top-down.
+
+// 8-bit RGBA PNG. Uses stored (uncompressed) deflate blocks, trading file
+// size for an encoder that costs little more than the disk write.
+void writePng(const std::string& path, int width, int height, const uint8_t* rgba);
+
+// Half-float RGBA OpenEXR, uncompressed scanlines. `rgba` holds IEEE half
+// values as produced by glGetTexImage with GL_HALF_FLOAT.
+void writeExr(const std::string& path, int width, int height, const uint16_t* rgba);
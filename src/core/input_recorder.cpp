@@ -0,0 +1,95 @@
+#include "input_recorder.hpp"
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+const char MAGIC[4] = {'A', 'G', 'I', 'R'};
+// Bumped whenever the simulation changes in a way that makes older
+// recordings replay differently; 2: fixed physics steps with continuous
+// collision, per-body sphere state and camera moves scaled by the frame dt
+const uint32_t VERSION = 2;
+// dt, keys, mouse delta, camera position and front
+const size_t RECORD_SIZE = 4 + 2 + 4 * 2 + 4 * 6;
+
+void putU32(uint8_t*& out, uint32_t v) {
+    for (int i = 0; i < 4; i++) *out++ = static_cast<uint8_t>(v >> (8 * i));
+}
+
+void putF32(uint8_t*& out, float f) {
+    uint32_t bits;
+    std::memcpy(&bits, &f, sizeof(bits));
+    putU32(out, bits);
+}
+
+uint32_t getU32(const uint8_t*& in) {
+    uint32_t v = 0;
+    for (int i = 0; i < 4; i++) v |= static_cast<uint32_t>(*in++) << (8 * i);
+    return v;
+}
+
+float getF32(const uint8_t*& in) {
+    uint32_t bits = getU32(in);
+    float f;
+    std::memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+} // namespace
+
+InputRecorder::InputRecorder(const std::string& path)
+    : stream(path, std::ios::binary) {
+    if (!stream.is_open()) {
+        throw std::runtime_error("Failed to open input recording: " + path);
+    }
+    uint8_t header[8];
+    uint8_t* out = header;
+    std::memcpy(out, MAGIC, 4);
+    out += 4;
+    putU32(out, VERSION);
+    stream.write(reinterpret_cast<const char*>(header), sizeof(header));
+}
+
+void InputRecorder::record(const InputFrame& input, const CameraRecord& camera) {
+    uint8_t record[RECORD_SIZE];
+    uint8_t* out = record;
+    putF32(out, input.deltaTime);
+    *out++ = static_cast<uint8_t>(input.keys);
+    *out++ = static_cast<uint8_t>(input.keys >> 8);
+    putF32(out, input.mouseDeltaX);
+    putF32(out, input.mouseDeltaY);
+    for (int i = 0; i < 3; i++) putF32(out, camera.position[i]);
+    for (int i = 0; i < 3; i++) putF32(out, camera.front[i]);
+    stream.write(reinterpret_cast<const char*>(record), sizeof(record));
+    frameCount++;
+}
+
+InputPlayer::InputPlayer(const std::string& path)
+    : stream(path, std::ios::binary) {
+    if (!stream.is_open()) {
+        throw std::runtime_error("Failed to open input recording: " + path);
+    }
+    uint8_t header[8];
+    stream.read(reinterpret_cast<char*>(header), sizeof(header));
+    const uint8_t* in = header + 4;
+    if (!stream || std::memcmp(header, MAGIC, 4) != 0 || getU32(in) != VERSION) {
+        throw std::runtime_error("Not a supported input recording: " + path);
+    }
+}
+
+bool InputPlayer::next(InputFrame& input, CameraRecord& camera) {
+    uint8_t record[RECORD_SIZE];
+    if (!stream.read(reinterpret_cast<char*>(record), sizeof(record))) {
+        return false;
+    }
+    const uint8_t* in = record;
+    input.deltaTime = getF32(in);
+    input.keys = static_cast<uint16_t>(in[0] | (in[1] << 8));
+    in += 2;
+    input.mouseDeltaX = getF32(in);
+    input.mouseDeltaY = getF32(in);
+    for (int i = 0; i < 3; i++) camera.position[i] = getF32(in);
+    for (int i = 0; i < 3; i++) camera.front[i] = getF32(in);
+    frameCount++;
+    return true;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+// Bits of InputFrame::keys
+enum InputKey : uint16_t {
+    INPUT_FORWARD       = 1 << 0,
+    INPUT_BACKWARD      = 1 << 1,
+    INPUT_LEFT          = 1 << 2,
+    INPUT_RIGHT         = 1 << 3,
+    INPUT_JUMP          = 1 << 4,
+    INPUT_AGE_UP        = 1 << 5,
+    INPUT_AGE_DOWN      = 1 << 6,
+    INPUT_MOISTURE_UP   = 1 << 7,
+    INPUT_MOISTURE_DOWN = 1 << 8
+};
+
+// Everything the simulation consumes from the user in one frame
+struct InputFrame {
+    float deltaTime{0.0f};
+    uint16_t keys{0};
+    float mouseDeltaX{0.0f};
+    float mouseDeltaY{0.0f};
+
+    bool isDown(InputKey key) const { return (keys & key) != 0; }
+};
+
+// Camera state at the end of a frame, stored to detect replay divergence
+struct CameraRecord {
+    glm::vec3 position{0.0f};
+    glm::vec3 front{0.0f};
+};
+
+// Writes one fixed-size little-endian record per frame after a short header
+class InputRecorder {
+public:
+    explicit InputRecorder(const std::string& path);
+    void record(const InputFrame& input, const CameraRecord& camera);
+    uint64_t getFrameCount() const { return frameCount; }
+
+private:
+    std::ofstream stream;
+    uint64_t frameCount{0};
+};
+
+class InputPlayer {
+public:
+    explicit InputPlayer(const std::string& path);
+    // Returns false once the recording is exhausted
+    bool next(InputFrame& input, CameraRecord& camera);
+    uint64_t getFrameCount() const { return frameCount; }
+
+private:
+    std::ifstream stream;
+    uint64_t frameCount{0};
+};
@@ -0,0 +1,115 @@
+#include "latency_tracker.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+void printStage(const char* name, std::vector<double> samples) {
+    if (samples.empty()) return;
+    std::sort(samples.begin(), samples.end());
+    double sum = 0.0;
+    for (double sample : samples) sum += sample;
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(2) << "  " << name << ": mean "
+         << sum / samples.size() * 1000.0 << " ms, median "
+         << samples[samples.size() / 2] * 1000.0 << " ms, p95 "
+         << samples[samples.size() * 95 / 100] * 1000.0 << " ms, max "
+         << samples.back() * 1000.0 << " ms";
+    std::cout << line.str() << std::endl;
+}
+
+} // namespace
+
+LatencyTracker::LatencyTracker(const std::string& tracePath) {
+    if (!tracePath.empty()) {
+        trace.open(tracePath);
+        trace << "frame,input_to_latch_ms,input_to_submit_ms,input_to_gpu_ms,input_to_swap_ms\n";
+    }
+}
+
+LatencyTracker::~LatencyTracker() {
+    for (const auto& frame : pending) {
+        glDeleteQueries(1, &frame.query);
+    }
+    if (!freeQueries.empty()) {
+        glDeleteQueries(static_cast<GLsizei>(freeQueries.size()), freeQueries.data());
+    }
+}
+
+void LatencyTracker::beginFrame(uint64_t frameIndex, double inputTime) {
+    current = Frame();
+    current.index = frameIndex;
+    current.input = inputTime;
+}
+
+void LatencyTracker::markLatch(double time) {
+    current.latch = time;
+}
+
+void LatencyTracker::markSubmit(double time) {
+    current.submit = time;
+    if (freeQueries.empty()) {
+        GLuint query;
+        glGenQueries(1, &query);
+        freeQueries.push_back(query);
+    }
+    current.query = freeQueries.back();
+    freeQueries.pop_back();
+    glQueryCounter(current.query, GL_TIMESTAMP);
+
+    // Re-measured every frame so the two clocks cannot drift apart
+    GLint64 gpuNow = 0;
+    glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+    current.clockOffset = time - gpuNow * 1.0e-9;
+}
+
+void LatencyTracker::markSwap(double time) {
+    current.swap = time;
+    pending.push_back(current);
+    resolve(false);
+}
+
+void LatencyTracker::resolve(bool wait) {
+    while (!pending.empty()) {
+        Frame& frame = pending.front();
+        if (!wait) {
+            GLint available = 0;
+            glGetQueryObjectiv(frame.query, GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) break;
+        }
+        GLuint64 gpuTime = 0;
+        glGetQueryObjectui64v(frame.query, GL_QUERY_RESULT, &gpuTime);
+        frame.gpuDone = gpuTime * 1.0e-9 + frame.clockOffset;
+        freeQueries.push_back(frame.query);
+        record(frame);
+        pending.pop_front();
+    }
+}
+
+void LatencyTracker::record(const Frame& frame) {
+    inputToSubmit.push_back(frame.submit - frame.input);
+    inputToGpu.push_back(frame.gpuDone - frame.input);
+    inputToSwap.push_back(frame.swap - frame.input);
+    if (frame.latch >= 0.0) {
+        latchToSwap.push_back(frame.swap - frame.latch);
+    }
+    if (trace.is_open()) {
+        trace << frame.index << ",";
+        if (frame.latch >= 0.0) {
+            trace << (frame.latch - frame.input) * 1000.0;
+        }
+        trace << "," << (frame.submit - frame.input) * 1000.0 << "," << (frame.gpuDone - frame.input) * 1000.0
+              << "," << (frame.swap - frame.input) * 1000.0 << "\n";
+    }
+}
+
+void LatencyTracker::report() {
+    resolve(true);
+    std::cout << "Latency over " << inputToSwap.size() << " frames:" << std::endl;
+    printStage("input to submit", inputToSubmit);
+    printStage("input to GPU done", inputToGpu);
+    printStage("input to swap", inputToSwap);
+    printStage("latch to swap", latchToSwap);
+}
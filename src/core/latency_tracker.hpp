@@ -0,0 +1,56 @@
+#pragma once
+#include <glad/glad.h>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Input-to-photon latency per frame. The render loop stamps when the
+// frame's input was sampled, when the camera was late-latched, when its
+// dispatch was submitted and when the swap returned; GPU completion comes
+// from a GL_TIMESTAMP query placed after the dispatch and mapped onto the
+// CPU clock. Queries are resolved a few frames later so nothing stalls.
+// All times are seconds on the glfwGetTime clock.
+class LatencyTracker {
+public:
+    // Per-frame rows go to `tracePath` as CSV when it is not empty
+    explicit LatencyTracker(const std::string& tracePath);
+    ~LatencyTracker();
+
+    LatencyTracker(const LatencyTracker&) = delete;
+    LatencyTracker& operator=(const LatencyTracker&) = delete;
+
+    void beginFrame(uint64_t frameIndex, double inputTime);
+    void markLatch(double time);
+    // Call right after the frame's dispatches have been issued
+    void markSubmit(double time);
+    void markSwap(double time);
+
+    // Prints mean, median, 95th percentile and worst latency of each stage
+    void report();
+
+private:
+    struct Frame {
+        uint64_t index{0};
+        double input{0.0};
+        double latch{-1.0};     // negative when the camera was not latched
+        double submit{0.0};
+        double swap{0.0};
+        double gpuDone{0.0};
+        double clockOffset{0.0}; // CPU seconds minus GPU seconds at submit
+        GLuint query{0};
+    };
+
+    std::ofstream trace;
+    Frame current;
+    std::deque<Frame> pending;   // waiting for their GPU timestamp
+    std::vector<GLuint> freeQueries;
+    std::vector<double> inputToSubmit;
+    std::vector<double> inputToGpu;
+    std::vector<double> inputToSwap;
+    std::vector<double> latchToSwap;
+
+    void resolve(bool wait);
+    void record(const Frame& frame);
+};
@@ -0,0 +1,166 @@
+#include "memory_tracker.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+const char* const CATEGORY_NAMES[] = {
+    "output image", "scene buffers", "uniforms", "water", "wavefront", "binning",
+    "sampling", "debris", "textures", "capture", "geometry", "profiling", "scene objects", "water trails", "physics",
+};
+
+double toMegabytes(size_t bytes) {
+    return bytes / (1024.0 * 1024.0);
+}
+
+} // namespace
+
+MemoryTracker& MemoryTracker::get() {
+    static MemoryTracker tracker;
+    return tracker;
+}
+
+void MemoryTracker::trackBuffer(GLuint buffer, size_t size, MemoryCategory category) {
+    track(false, buffer, size, category);
+}
+
+void MemoryTracker::trackTexture(GLuint texture, size_t size, MemoryCategory category) {
+    track(true, texture, size, category);
+}
+
+void MemoryTracker::releaseBuffer(GLuint buffer) {
+    release(false, buffer);
+}
+
+void MemoryTracker::releaseTexture(GLuint texture) {
+    release(true, texture);
+}
+
+void MemoryTracker::track(bool texture, GLuint name, size_t size, MemoryCategory category) {
+    if (name == 0) return;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = allocations.find({texture, name});
+    if (it != allocations.end()) {
+        adjust(it->second.category, it->second.bytes, 0);
+    }
+    allocations[{texture, name}] = Allocation{size, category};
+    adjust(category, 0, size);
+}
+
+void MemoryTracker::release(bool texture, GLuint name) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = allocations.find({texture, name});
+    if (it == allocations.end()) return;
+    adjust(it->second.category, it->second.bytes, 0);
+    allocations.erase(it);
+}
+
+void MemoryTracker::setCpuUsage(MemoryCategory category, size_t size) {
+    std::lock_guard<std::mutex> lock(mutex);
+    adjust(category, bytes[static_cast<int>(category)], size);
+}
+
+void MemoryTracker::adjust(MemoryCategory category, size_t oldBytes, size_t newBytes) {
+    const int index = static_cast<int>(category);
+    bytes[index] = bytes[index] - oldBytes + newBytes;
+    peaks[index] = std::max(peaks[index], bytes[index]);
+
+    const bool gpuSide = isGpuCategory(category);
+    Side& side = gpuSide ? gpu : cpu;
+    side.bytes = side.bytes - oldBytes + newBytes;
+    side.peak = std::max(side.peak, side.bytes);
+    checkBudget(side, gpuSide ? "GPU" : "CPU");
+}
+
+void MemoryTracker::checkBudget(Side& side, const char* name) {
+    const bool over = side.budget > 0 && side.bytes > side.budget;
+    if (over && !side.warned) {
+        std::ostringstream message;
+        message << std::fixed << std::setprecision(1) << "Warning: " << name << " memory "
+                << toMegabytes(side.bytes) << " MB exceeds the budget of " << toMegabytes(side.budget) << " MB";
+        std::cerr << message.str() << std::endl;
+    }
+    side.warned = over;
+}
+
+size_t MemoryTracker::getBytes(MemoryCategory category) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return bytes[static_cast<int>(category)];
+}
+
+size_t MemoryTracker::getPeakBytes(MemoryCategory category) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return peaks[static_cast<int>(category)];
+}
+
+size_t MemoryTracker::getGpuBytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return gpu.bytes;
+}
+
+size_t MemoryTracker::getGpuPeakBytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return gpu.peak;
+}
+
+size_t MemoryTracker::getCpuBytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return cpu.bytes;
+}
+
+size_t MemoryTracker::getCpuPeakBytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return cpu.peak;
+}
+
+void MemoryTracker::setGpuBudget(size_t budget) {
+    std::lock_guard<std::mutex> lock(mutex);
+    gpu.budget = budget;
+    checkBudget(gpu, "GPU");
+}
+
+void MemoryTracker::setCpuBudget(size_t budget) {
+    std::lock_guard<std::mutex> lock(mutex);
+    cpu.budget = budget;
+    checkBudget(cpu, "CPU");
+}
+
+bool MemoryTracker::isOverBudget() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return gpu.warned || cpu.warned;
+}
+
+void MemoryTracker::report(std::ostream& out) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    // Fixed point for this report only, the caller's format is restored below
+    const std::ios::fmtflags flags = out.flags();
+    const std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(2) << "Memory (MB, live / peak):" << std::endl;
+    for (int i = 0; i < static_cast<int>(MemoryCategory::Count); i++) {
+        const MemoryCategory category = static_cast<MemoryCategory>(i);
+        out << "  " << (isGpuCategory(category) ? "gpu " : "cpu ") << CATEGORY_NAMES[i] << ": "
+            << toMegabytes(bytes[i]) << " / " << toMegabytes(peaks[i]) << std::endl;
+    }
+    const Side* sides[] = {&gpu, &cpu};
+    const char* names[] = {"GPU", "CPU"};
+    for (int i = 0; i < 2; i++) {
+        out << "  " << names[i] << " total: " << toMegabytes(sides[i]->bytes) << " / "
+            << toMegabytes(sides[i]->peak);
+        if (sides[i]->budget > 0) {
+            out << ", budget " << toMegabytes(sides[i]->budget);
+        }
+        out << std::endl;
+    }
+    out.flags(flags);
+    out.precision(precision);
+}
+
+const char* MemoryTracker::getCategoryName(MemoryCategory category) {
+    return CATEGORY_NAMES[static_cast<int>(category)];
+}
+
+bool MemoryTracker::isGpuCategory(MemoryCategory category) {
+    return category < MemoryCategory::SceneObjects;
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <glad/glad.h>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <utility>
+
+// What an allocation is for. GPU categories count GL buffers and textures,
+// CPU categories count heap memory sampled from the simulation.
+enum class MemoryCategory {
+    OutputImage,    // megakernel output and multi-view array
+    SceneBuffers,   // object records and per-view cameras
+    Uniforms,       // uniform block rings
+    Water,          // water simulation state
+    Wavefront,      // wavefront ray, hit and counter queues
+    Binning,        // per-tile object lists
+    Sampling,       // adaptive supersampling pixel info and refine list
+    Debris,         // GPU rigid body state, grid and impact readback
+    Textures,       // material textures loaded from disk
+    Capture,        // frame capture readback buffers
+    Geometry,       // vertex buffers
+    Profiling,      // shader performance counter image and totals
+    SceneObjects,   // CPU: scene object records and aging stress points
+    WaterTrails,    // CPU: water trails attached to scene objects
+    Physics,        // CPU: active bodies, contacts and island scratch
+    Count
+};
+
+// Process-wide record of what the renderer has allocated. GL objects are
+// registered by name when their storage is (re)specified and released when
+// deleted; CPU categories are overwritten with a fresh estimate each frame.
+// Totals, per-category high-water marks and budgets are kept per side.
+// Safe to call from the simulation thread.
+class MemoryTracker {
+public:
+    static MemoryTracker& get();
+
+    // Re-tracking a name replaces its previous size and category
+    void trackBuffer(GLuint buffer, size_t bytes, MemoryCategory category);
+    void trackTexture(GLuint texture, size_t bytes, MemoryCategory category);
+    void releaseBuffer(GLuint buffer);
+    void releaseTexture(GLuint texture);
+    void setCpuUsage(MemoryCategory category, size_t bytes);
+
+    size_t getBytes(MemoryCategory category) const;
+    size_t getPeakBytes(MemoryCategory category) const;
+    size_t getGpuBytes() const;
+    size_t getGpuPeakBytes() const;
+    size_t getCpuBytes() const;
+    size_t getCpuPeakBytes() const;
+
+    // Crossing a budget prints one warning until usage falls back under it;
+    // zero means unlimited
+    void setGpuBudget(size_t bytes);
+    void setCpuBudget(size_t bytes);
+    bool isOverBudget() const;
+
+    // Live and peak bytes of every category, then the totals and budgets
+    void report(std::ostream& out) const;
+
+    static const char* getCategoryName(MemoryCategory category);
+    static bool isGpuCategory(MemoryCategory category);
+
+private:
+    struct Allocation {
+        size_t bytes;
+        MemoryCategory category;
+    };
+    struct Side {
+        size_t bytes{0};
+        size_t peak{0};
+        size_t budget{0};
+        bool warned{false};
+    };
+
+    mutable std::mutex mutex;
+    // Keyed by (is texture, GL name), buffer and texture names overlap
+    std::map<std::pair<bool, GLuint>, Allocation> allocations;
+    size_t bytes[static_cast<int>(MemoryCategory::Count)]{};
+    size_t peaks[static_cast<int>(MemoryCategory::Count)]{};
+    Side gpu;
+    Side cpu;
+
+    MemoryTracker() = default;
+    void track(bool texture, GLuint name, size_t size, MemoryCategory category);
+    void release(bool texture, GLuint name);
+    void adjust(MemoryCategory category, size_t oldBytes, size_t newBytes);
+    static void checkBudget(Side& side, const char* name);
+};
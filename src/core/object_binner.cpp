@@ -0,0 +1,64 @@
+#include "object_binner.hpp"
+#include "memory_tracker.hpp"
+#include "renderer.hpp"
+
+ObjectBinner::~ObjectBinner() {
+    glDeleteProgram(program);
+    MemoryTracker::get().releaseBuffer(buffer);
+    glDeleteBuffers(1, &buffer);
+}
+
+void ObjectBinner::configure(const glm::ivec2& tile, bool latched) {
+    if (program != 0 && tile == tileSize && latched == lateLatch) {
+        return;
+    }
+    std::vector<std::string> defines = getTracerDefines();
+    defines.push_back("TILE_WIDTH " + std::to_string(tile.x));
+    defines.push_back("TILE_HEIGHT " + std::to_string(tile.y));
+    if (latched) {
+        defines.push_back("LATE_LATCH");
+    }
+    GLuint newProgram = Renderer::createComputeProgram("shaders/binning/bin_objects.comp", defines);
+    glDeleteProgram(program);
+    program = newProgram;
+    tileSize = tile;
+    lateLatch = latched;
+    binGridLoc = glGetUniformLocation(program, "binGrid");
+    pixelOffsetLoc = glGetUniformLocation(program, "pixelOffset");
+    imageSizeLoc = glGetUniformLocation(program, "outputSize");
+}
+
+void ObjectBinner::bin(const glm::ivec2& imageSize, const glm::ivec2& origin, const glm::ivec2& regionSize,
+                       int objectCount) {
+    grid = (regionSize + tileSize - 1) / tileSize;
+    const size_t binCount = static_cast<size_t>(grid.x) * grid.y + 1; // + the global list
+    const size_t countBytes = binCount * sizeof(GLuint);
+    const size_t size = countBytes + binCount * MAX_BIN_OBJECTS * sizeof(GLuint);
+    if (size > bufferSize) {
+        if (buffer == 0) {
+            glGenBuffers(1, &buffer);
+        }
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, size, nullptr, GL_DYNAMIC_COPY);
+        bufferSize = size;
+        MemoryTracker::get().trackBuffer(buffer, size, MemoryCategory::Binning);
+    }
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, BUFFER_BINDING, buffer);
+
+    // Only the counts need resetting, stale list entries past them are unread
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+    glClearBufferSubData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, 0, countBytes, GL_RED_INTEGER, GL_UNSIGNED_INT,
+                         nullptr);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    glUseProgram(program);
+    glUniform2i(binGridLoc, grid.x, grid.y);
+    glUniform2i(pixelOffsetLoc, origin.x, origin.y);
+    glUniform2i(imageSizeLoc, imageSize.x, imageSize.y);
+    glDispatchCompute((objectCount + 63) / 64, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+std::vector<std::string> ObjectBinner::getTracerDefines() {
+    return {"OBJECT_BINNING", "MAX_BIN_OBJECTS " + std::to_string(MAX_BIN_OBJECTS)};
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+
+// Screen-space binning pre-pass for the megakernel. One invocation per
+// object projects its bounding sphere with the frame's camera and appends
+// the object to the list of every dispatch tile it may cover. Each tracer
+// workgroup then copies its own tile's list to shared memory and tests only
+// those objects, plus a short global list of objects that cannot be
+// projected (the ground, anything reaching behind the camera, anything
+// covering most of the screen). A full list makes its tile test everything.
+class ObjectBinner {
+public:
+    static const int MAX_BIN_OBJECTS = 64; // per tile, matches bins.glsl
+    static const GLuint BUFFER_BINDING = 8;
+
+    ObjectBinner() = default;
+    ~ObjectBinner();
+
+    ObjectBinner(const ObjectBinner&) = delete;
+    ObjectBinner& operator=(const ObjectBinner&) = delete;
+
+    // Rebuilds the program when the tracer's tile shape or camera source
+    // changed; bins must match its workgroups
+    void configure(const glm::ivec2& tileSize, bool lateLatch);
+    // Bins for a dispatch covering `regionSize` pixels from `origin` of an
+    // image of `imageSize`. Frame constants and objects must be bound.
+    void bin(const glm::ivec2& imageSize, const glm::ivec2& origin, const glm::ivec2& regionSize, int objectCount);
+    // Tiles in x and y of the last bin() call
+    glm::ivec2 getGrid() const { return grid; }
+
+    // Defines the tracer needs to read the bins
+    static std::vector<std::string> getTracerDefines();
+
+private:
+    GLuint program{0};
+    GLuint buffer{0};
+    size_t bufferSize{0};
+    glm::ivec2 tileSize{0};
+    bool lateLatch{false};
+    glm::ivec2 grid{0};
+    GLint binGridLoc{-1};
+    GLint pixelOffsetLoc{-1};
+    GLint imageSizeLoc{-1};
+};
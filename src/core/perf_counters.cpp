@@ -0,0 +1,82 @@
+#include "perf_counters.hpp"
+#include "memory_tracker.hpp"
+#include <cstring>
+#include <iomanip>
+
+namespace {
+
+const char* const MATERIAL_NAMES[] = {"sky", "steel", "wood", "paint", "brick", "ground"};
+
+double perPixel(uint32_t total, uint32_t pixels) {
+    return pixels > 0 ? static_cast<double>(total) / pixels : 0.0;
+}
+
+} // namespace
+
+void PerfTotals::report(std::ostream& out) const {
+    const std::ios::fmtflags flags = out.flags();
+    const std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(2);
+    out << "Shader work over " << pixels << " pixels (mean / max per pixel):" << std::endl;
+    out << "  march steps: " << perPixel(marchSteps, pixels) << " / " << maxMarchSteps << std::endl;
+    out << "  object tests: " << perPixel(objectTests, pixels) << " / " << maxObjectTests << std::endl;
+    out << "  noise calls: " << perPixel(noiseCalls, pixels) << " / " << maxNoiseCalls << std::endl;
+    out << "  pixels by material:";
+    for (int i = 0; i < 6; i++) {
+        out << " " << MATERIAL_NAMES[i] << " " << materialPixels[i];
+    }
+    out << std::endl;
+    out.flags(flags);
+    out.precision(precision);
+}
+
+PerfCounters::~PerfCounters() {
+    MemoryTracker::get().releaseTexture(texture);
+    MemoryTracker::get().releaseBuffer(totalsBuffer);
+    glDeleteTextures(1, &texture);
+    glDeleteBuffers(1, &totalsBuffer);
+}
+
+void PerfCounters::begin(const glm::ivec2& imageSize) {
+    if (totalsBuffer == 0) {
+        glGenBuffers(1, &totalsBuffer);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, totalsBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(PerfTotals), nullptr, GL_DYNAMIC_READ);
+        MemoryTracker::get().trackBuffer(totalsBuffer, sizeof(PerfTotals), MemoryCategory::Profiling);
+    }
+    if (imageSize != size) {
+        MemoryTracker::get().releaseTexture(texture);
+        glDeleteTextures(1, &texture);
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA32UI, imageSize.x, imageSize.y);
+        // Integer textures only sample unfiltered
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        MemoryTracker::get().trackTexture(texture, static_cast<size_t>(imageSize.x) * imageSize.y * 16,
+                                          MemoryCategory::Profiling);
+        size = imageSize;
+    }
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, totalsBuffer);
+    glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, TOTALS_BINDING, totalsBuffer);
+    glBindImageTexture(IMAGE_UNIT, texture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA32UI);
+}
+
+PerfTotals PerfCounters::readTotals() const {
+    PerfTotals totals;
+    std::memset(&totals, 0, sizeof(totals));
+    if (totalsBuffer == 0) {
+        return totals;
+    }
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, totalsBuffer);
+    glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(totals), &totals);
+    return totals;
+}
+
+std::vector<std::string> PerfCounters::getTracerDefines() {
+    return {"PERF_COUNTERS"};
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Work counted by the PERF_COUNTERS tracer variant over one frame. Matches
+// PerfTotals in shaders/common/perf_counters.glsl.
+struct PerfTotals {
+    uint32_t marchSteps;
+    uint32_t objectTests;
+    uint32_t noiseCalls;
+    uint32_t pixels;
+    uint32_t maxMarchSteps;
+    uint32_t maxObjectTests;
+    uint32_t maxNoiseCalls;
+    uint32_t padding;
+    uint32_t materialPixels[8]; // sky, steel, wood, paint, brick, ground
+
+    void report(std::ostream& out) const;
+};
+
+// Per-pixel cost counters for the single-view megakernel. The instrumented
+// tracer writes ground march steps, object tests, noise calls and the shaded
+// material of each pixel into an integer image, and frame totals into a
+// small storage buffer that the host can read back and the display pass can
+// use to scale its heatmap. The atomics slow the trace down, so compare the
+// counts between views rather than its timings.
+class PerfCounters {
+public:
+    static const GLuint TOTALS_BINDING = 15;  // matches perf_counters.glsl
+    static const GLuint IMAGE_UNIT = 3;
+
+    PerfCounters() = default;
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    // Before the dispatch: sizes the counter image to the output image,
+    // zeroes the totals and binds both
+    void begin(const glm::ivec2& imageSize);
+    // Waits for the frame's totals; meant for reports, not every frame
+    PerfTotals readTotals() const;
+    // Integer RGBA image of steps, tests, noise calls and material
+    GLuint getTexture() const { return texture; }
+    GLuint getTotalsBuffer() const { return totalsBuffer; }
+
+    // Defines the tracer needs to count
+    static std::vector<std::string> getTracerDefines();
+
+private:
+    GLuint texture{0};
+    GLuint totalsBuffer{0};
+    glm::ivec2 size{0};
+};
@@ -1,6 +1,85 @@
 #include "physics.hpp"
 #include "scene.hpp"
 #include <GLFW/glfw3.h>
+#include <cmath>
+
+namespace {
+
+const float WALL_Z = -5.0f;
+const float WALL_HALF_WIDTH = 5.0f;
+const float WALL_HEIGHT = 5.0f;
+const float WALL_RESTITUTION = 0.5f;
+// Half extents of a painting's collision box
+const glm::vec3 RECTANGLE_HALF_EXTENTS(1.0f, 1.0f, 0.1f);
+// Distance kept from a surface after a time-of-impact stop
+const float CONTACT_SKIN = 1e-4f;
+// Gap up to which resting spheres still count as touching
+const float SLEEP_CONTACT_MARGIN = 0.01f;
+
+// Earliest fraction of `d` at which a sphere of `radius` starting at `p`
+// touches the half-space boundary dot(n, x) = offset from the positive side
+bool sweepPlane(const glm::vec3& p, const glm::vec3& d, float radius,
+                const glm::vec3& n, float offset, float& fraction) {
+    float distance = glm::dot(n, p) - offset - radius;
+    float approach = glm::dot(n, d);
+    if (approach >= 0.0f) return false;
+    if (distance < 0.0f) {
+        // Already touching; let the overlap pass resolve it
+        return false;
+    }
+    fraction = distance / -approach;
+    return fraction <= 1.0f;
+}
+
+// Segment p..p+d against a sphere around `center`
+bool sweepPoint(const glm::vec3& p, const glm::vec3& d, const glm::vec3& center,
+                float radius, float& fraction) {
+    glm::vec3 m = p - center;
+    float a = glm::dot(d, d);
+    float b = glm::dot(m, d);
+    float c = glm::dot(m, m) - radius * radius;
+    if (a <= 0.0f || c <= 0.0f || b >= 0.0f) return false;
+    float discriminant = b * b - a * c;
+    if (discriminant < 0.0f) return false;
+    fraction = (-b - std::sqrt(discriminant)) / a;
+    return fraction <= 1.0f;
+}
+
+// Segment p..p+d against a box grown by `radius` (slab test). Corners are
+// treated as square, which only makes the sweep slightly conservative.
+bool sweepBox(const glm::vec3& p, const glm::vec3& d, const glm::vec3& center,
+              const glm::vec3& halfExtents, float radius, float& fraction, glm::vec3& normal) {
+    glm::vec3 lo = center - halfExtents - glm::vec3(radius);
+    glm::vec3 hi = center + halfExtents + glm::vec3(radius);
+    float tEnter = 0.0f;
+    float tExit = 1.0f;
+    int enterAxis = -1;
+    for (int axis = 0; axis < 3; axis++) {
+        if (std::abs(d[axis]) < 1e-8f) {
+            if (p[axis] < lo[axis] || p[axis] > hi[axis]) return false;
+            continue;
+        }
+        float t0 = (lo[axis] - p[axis]) / d[axis];
+        float t1 = (hi[axis] - p[axis]) / d[axis];
+        if (t0 > t1) std::swap(t0, t1);
+        if (t0 > tEnter) {
+            tEnter = t0;
+            enterAxis = axis;
+        }
+        tExit = std::min(tExit, t1);
+        if (tEnter > tExit) return false;
+    }
+    if (enterAxis < 0) {
+        // Starts inside the grown box; the overlap pass handles it
+        return false;
+    }
+    fraction = tEnter;
+    normal = glm::vec3(0.0f);
+    normal[enterAxis] = d[enterAxis] > 0.0f ? -1.0f : 1.0f;
+    return true;
+}
+
+} // namespace
 
 Physics::Physics(const std::vector<SceneObject>& objects)
     : objectsInScene(&objects) {
@@ -28,18 +107,49 @@ void Physics::update(float deltaTime) {
     // Handle camera collisions
     handleCollisions();
 
-    // Update all scene objects
+    // Update all scene objects in fixed steps
     if (objectsInScene) {
-        for (auto& obj : *const_cast<std::vector<SceneObject>*>(objectsInScene)) {
-            if (obj.isDynamic) {
-                updateObject(obj);
+        std::vector<SceneObject>& objects = sceneObjects();
+        if (!activeListValid) {
+            rebuildActiveList();
+        }
+        if (sphereDisturbed) {
+            // The camera's push lands on its sphere body only
+            if (cameraBody != NO_BODY) {
+                SceneObject& body = objects[cameraBody];
+                body.position = spherePosition;
+                body.velocity = sphereVelocity;
+                wakeBody(body);
             }
+            sphereDisturbed = false;
+        }
+
+        accumulator += deltaTime;
+        int steps = 0;
+        while (accumulator >= fixedTimestep && steps < MAX_STEPS_PER_UPDATE) {
+            contacts.clear();
+            // wakeBody may append while iterating; those start next step
+            const size_t activeCount = activeBodies.size();
+            for (size_t i = 0; i < activeCount; i++) {
+                updateObject(objects[activeBodies[i]], fixedTimestep);
+            }
+            updateSleepStates(fixedTimestep);
+            accumulator -= fixedTimestep;
+            steps++;
+        }
+        if (steps == MAX_STEPS_PER_UPDATE) {
+            // Too far behind to catch up; drop the backlog instead of spiralling
+            accumulator = 0.0f;
+        }
+        if (cameraBody != NO_BODY) {
+            spherePosition = objects[cameraBody].position;
+            sphereVelocity = objects[cameraBody].velocity;
         }
     }
 }
 
-void Physics::updateCameraPosition(glm::vec3& position) {
-    glm::vec3 newPos = position + cameraVelocity * 0.016f;
+void Physics::updateCameraPosition(glm::vec3& position, float deltaTime) {
+    glm::vec3 newPos = position + cameraVelocity * deltaTime;
     bool collision = false;
 
     // Check sphere collision first
@@ -48,6 +158,7 @@ void Physics::updateCameraPosition(glm::vec3& position) {
 
     if (distance < (CAMERA_RADIUS + SPHERE_RADIUS)) {
         // Collision detected
+        sphereDisturbed = true;
         glm::vec3 normal = glm::normalize(toSphere);
         float penetration = CAMERA_RADIUS + SPHERE_RADIUS - distance;
 
@@ -120,6 +231,7 @@ bool Physics::checkSphereCollision(const glm::vec3& position, float radius) {
         float overlap = (radius + SPHERE_RADIUS) - distance;
 
         // Move sphere away from collision
+        sphereDisturbed = true;
         spherePosition += normal * overlap * 0.5f;
 
         // Apply impulse based on camera velocity
@@ -137,32 +249,15 @@ bool Physics::checkGroundCollision(const glm::vec3& position, float height) {
     return position.y - height/2.0f < groundHeight;
 }
 
-void Physics::updateObject(SceneObject& obj) {
+void Physics::updateObject(SceneObject& obj, float deltaTime) {
     if (!obj.isDynamic) return;
-
-    if (obj.type == ObjectType::SPHERE) {
-        // Sync sphere position and velocity with Physics system
-        obj.position = spherePosition;
-        obj.velocity = sphereVelocity;
-    }
-
-    updateDynamicObject(obj, 0.016f);
-
-    if (obj.type == ObjectType::SPHERE) {
-        // Update Physics system with new position and velocity
-        spherePosition = obj.position;
-        sphereVelocity = obj.velocity;
-    }
+    updateDynamicObject(obj, deltaTime);
 }
 
 void Physics::handleObjectCollisions(SceneObject& obj) {
     // Ground collision
     float bottomY;
     float radius;
-    const float WALL_RESTITUTION = 0.5f;
-    const float WALL_Z = -5.0f;
-    const float WALL_HALF_WIDTH = 5.0f;
-    const float WALL_HEIGHT = 5.0f;
 
     switch(obj.type) {
         case ObjectType::SPHERE:
@@ -242,6 +337,11 @@ void Physics::handleObjectCollisions(SceneObject& obj) {
             float dist = glm::length(diff);
             float minDist = SPHERE_RADIUS * 2.0f;
 
+            // Touching bodies share an island, even without overlap
+            if (dist < minDist + SLEEP_CONTACT_MARGIN) {
+                recordContact(obj, other);
+            }
+
             if (dist < minDist) {
                 // Collision response
                 glm::vec3 normal = glm::normalize(diff);
@@ -286,16 +386,281 @@ void Physics::handleObjectCollisions(SceneObject& obj) {
     }
 }
 
+bool Physics::sweepSphere(const SceneObject& obj, const glm::vec3& displacement, float radius,
+                          SweepHit& hit) const {
+    const glm::vec3& p = obj.position;
+    hit.fraction = 2.0f;
+    float fraction;
+
+    // Static room: floor, back wall, side walls and ceiling
+    const struct {
+        glm::vec3 normal;
+        float offset;
+        bool ground;
+    } planes[] = {
+        {{0.0f, 1.0f, 0.0f}, GROUND_Y, true},
+        {{0.0f, 0.0f, 1.0f}, WALL_Z, false},
+        {{1.0f, 0.0f, 0.0f}, -WALL_HALF_WIDTH - radius, false},
+        {{-1.0f, 0.0f, 0.0f}, -WALL_HALF_WIDTH - radius, false},
+        {{0.0f, -1.0f, 0.0f}, -WALL_HEIGHT, false},
+    };
+    for (const auto& plane : planes) {
+        if (sweepPlane(p, displacement, radius, plane.normal, plane.offset, fraction) &&
+            fraction < hit.fraction) {
+            hit = {fraction, plane.normal, plane.ground, nullptr};
+        }
+    }
+
+    for (const auto& other : *objectsInScene) {
+        if (&other == &obj) continue;
+        glm::vec3 normal;
+        if (other.type == ObjectType::SPHERE) {
+            if (sweepPoint(p, displacement, other.position, radius + SPHERE_RADIUS, fraction) &&
+                fraction < hit.fraction) {
+                normal = glm::normalize(p + displacement * fraction - other.position);
+                hit = {fraction, normal, false, &other};
+            }
+        } else if (other.type == ObjectType::RECTANGLE) {
+            if (sweepBox(p, displacement, other.position, RECTANGLE_HALF_EXTENTS, radius, fraction, normal) &&
+                fraction < hit.fraction) {
+                hit = {fraction, normal, false, &other};
+            }
+        }
+    }
+    return hit.fraction <= 1.0f;
+}
+
+void Physics::respondToImpact(SceneObject& obj, const SweepHit& hit, float radius) {
+    if (hit.other) {
+        recordContact(obj, *hit.other);
+    }
+    float normalVel = glm::dot(obj.velocity, hit.normal);
+    if (normalVel >= 0.0f) return;
+
+    if (normalVel > -RESTING_SPEED && (!hit.other || hit.other->type != ObjectType::SPHERE)) {
+        // Resting contact: cancel the approach instead of bouncing, so
+        // bodies on the ground settle and can fall asleep
+        obj.velocity -= normalVel * hit.normal;
+        return;
+    }
+
+    if (hit.other && hit.other->type == ObjectType::SPHERE) {
+        // Same split impulse as the overlap response
+        float relativeVel = glm::dot(obj.velocity - hit.other->velocity, hit.normal);
+        if (relativeVel < 0.0f) {
+            obj.velocity += hit.normal * (-(1.0f + RESTITUTION) * relativeVel * 0.5f);
+        }
+        return;
+    }
+
+    if (hit.ground) {
+        obj.velocity.y = -obj.velocity.y * RESTITUTION;
+        float impactSpeed = glm::length(obj.velocity);
+        if (impactSpeed > 0.5f) {
+            float intensity = glm::clamp(impactSpeed / 15.0f, 0.0f, 0.8f);
+            obj.addWaterTrail(obj.position - glm::vec3(0.0f, radius - 0.01f, 0.0f), intensity);
+        }
+        return;
+    }
+
+    // Walls, ceiling and paintings
+    obj.velocity -= (1.0f + WALL_RESTITUTION) * normalVel * hit.normal;
+}
+
 void Physics::updateDynamicObject(SceneObject& obj, float deltaTime) {
     // Apply gravity
     obj.velocity.y += GRAVITY * deltaTime;
 
-    // Update position
-    obj.position += obj.velocity * deltaTime;
+    // Sweep the sphere along its path and stop at each time of impact, so
+    // fast objects cannot step over thin geometry between steps
+    if (obj.type == ObjectType::SPHERE) {
+        float remaining = deltaTime;
+        for (int i = 0; i < MAX_CCD_ITERATIONS && remaining > 0.0f; i++) {
+            SweepHit hit;
+            glm::vec3 displacement = obj.velocity * remaining;
+            if (!sweepSphere(obj, displacement, SPHERE_RADIUS, hit)) {
+                obj.position += displacement;
+                remaining = 0.0f;
+                break;
+            }
+            obj.position += displacement * hit.fraction + hit.normal * CONTACT_SKIN;
+            respondToImpact(obj, hit, SPHERE_RADIUS);
+            remaining *= 1.0f - hit.fraction;
+        }
+    } else {
+        obj.position += obj.velocity * deltaTime;
+    }
 
-    // Handle collisions
+    // Resolve anything left overlapping
     handleObjectCollisions(obj);
 
     // Apply air resistance
     obj.velocity *= (1.0f - AIR_RESISTANCE * deltaTime);
 }
+
+void Physics::rebuildActiveList() {
+    activeBodies.clear();
+    wakeIncompleteIslands();
+    const std::vector<SceneObject>& objects = *objectsInScene;
+    size_t firstSphere = NO_BODY;
+    for (size_t i = 0; i < objects.size(); i++) {
+        if (objects[i].isDynamic && !objects[i].sleeping) {
+            activeBodies.push_back(i);
+        }
+        if (firstSphere == NO_BODY && objects[i].isDynamic && objects[i].type == ObjectType::SPHERE) {
+            firstSphere = i;
+        }
+    }
+    if (firstSphere != cameraBody) {
+        // A new camera sphere: the camera now collides with where it is
+        cameraBody = firstSphere;
+        if (cameraBody != NO_BODY) {
+            spherePosition = objects[cameraBody].position;
+            sphereVelocity = objects[cameraBody].velocity;
+        }
+    }
+    islandParent.resize(objects.size());
+    islandBlocked.resize(objects.size());
+    islandIds.resize(objects.size());
+    activeListValid = true;
+}
+
+void Physics::wakeIncompleteIslands() {
+    // A removed or streamed out member may have been what the others rest on
+    std::map<uint32_t, size_t> members;
+    for (const auto& obj : *objectsInScene) {
+        if (obj.sleeping && obj.sleepIsland != 0) {
+            members[obj.sleepIsland]++;
+        }
+    }
+    for (auto it = sleepingIslands.begin(); it != sleepingIslands.end();) {
+        auto found = members.find(it->first);
+        if (found != members.end() && found->second < it->second) {
+            for (auto& obj : sceneObjects()) {
+                if (obj.sleeping && obj.sleepIsland == it->first) setAwake(obj);
+            }
+        }
+        if (found == members.end() || found->second < it->second) {
+            it = sleepingIslands.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void Physics::setAwake(SceneObject& obj) {
+    obj.sleeping = false;
+    obj.sleepTimer = 0.0f;
+    obj.sleepIsland = 0;
+    if (activeListValid) {
+        activeBodies.push_back(static_cast<size_t>(&obj - objectsInScene->data()));
+    }
+}
+
+void Physics::wakeBody(SceneObject& obj) {
+    obj.sleepTimer = 0.0f;
+    if (!obj.sleeping || !objectsInScene) return;
+    const uint32_t island = obj.sleepIsland;
+    if (island == 0) {
+        setAwake(obj);
+        return;
+    }
+    // Its island mates may rest on it, so they all wake
+    sleepingIslands.erase(island);
+    for (auto& member : sceneObjects()) {
+        if (member.sleeping && member.sleepIsland == island) setAwake(member);
+    }
+}
+
+void Physics::mergeIslands(uint32_t from, uint32_t into) {
+    for (auto& obj : sceneObjects()) {
+        if (obj.sleeping && obj.sleepIsland == from) obj.sleepIsland = into;
+    }
+    auto found = sleepingIslands.find(from);
+    if (found != sleepingIslands.end()) {
+        sleepingIslands[into] += found->second;
+        sleepingIslands.erase(found);
+    }
+}
+
+void Physics::recordContact(SceneObject& obj, const SceneObject& other) {
+    if (!other.isDynamic) return;
+    // A gentle touch only joins the island; a real hit wakes the body
+    SceneObject& otherBody = const_cast<SceneObject&>(other);
+    if (otherBody.sleeping && glm::length(obj.velocity) >= WAKE_SPEED) {
+        wakeBody(otherBody);
+    }
+    const SceneObject* base = objectsInScene->data();
+    contacts.emplace_back(static_cast<size_t>(&obj - base), static_cast<size_t>(&other - base));
+}
+
+size_t Physics::findIsland(size_t body) {
+    while (islandParent[body] != body) {
+        islandParent[body] = islandParent[islandParent[body]];
+        body = islandParent[body];
+    }
+    return body;
+}
+
+void Physics::updateSleepStates(float deltaTime) {
+    std::vector<SceneObject>& objects = sceneObjects();
+
+    // Union-find over this step's contacts; only touched entries are reset
+    for (size_t body : activeBodies) {
+        islandParent[body] = body;
+        islandBlocked[body] = 0;
+        islandIds[body] = 0;
+    }
+    for (const auto& contact : contacts) {
+        for (size_t body : {contact.first, contact.second}) {
+            islandParent[body] = body;
+            islandBlocked[body] = 0;
+            islandIds[body] = 0;
+        }
+    }
+    for (const auto& contact : contacts) {
+        size_t a = findIsland(contact.first);
+        size_t b = findIsland(contact.second);
+        if (a != b) islandParent[a] = b;
+    }
+
+    // An island may sleep only when every awake member has been slow long enough
+    for (size_t body : activeBodies) {
+        SceneObject& obj = objects[body];
+        if (glm::length(obj.velocity) < SLEEP_SPEED) {
+            obj.sleepTimer += deltaTime;
+        } else {
+            obj.sleepTimer = 0.0f;
+        }
+        if (obj.sleepTimer < SLEEP_TIME) {
+            islandBlocked[findIsland(body)] = 1;
+        }
+    }
+
+    auto asleep = [&](size_t body) {
+        const size_t root = findIsland(body);
+        if (islandBlocked[root]) return false;
+        if (islandIds[root] == 0) {
+            islandIds[root] = nextIsland++;
+        }
+        SceneObject& obj = objects[body];
+        obj.sleeping = true;
+        obj.velocity = glm::vec3(0.0f);
+        obj.sleepIsland = islandIds[root];
+        sleepingIslands[obj.sleepIsland]++;
+        return true;
+    };
+    activeBodies.erase(std::remove_if(activeBodies.begin(), activeBodies.end(), asleep), activeBodies.end());
+
+    // Sleepers touched by an island that just fell asleep join it, together
+    // with the rest of their own island
+    for (const auto& contact : contacts) {
+        for (size_t body : {contact.first, contact.second}) {
+            const SceneObject& obj = objects[body];
+            const uint32_t island = islandIds[findIsland(body)];
+            if (obj.sleeping && island != 0 && obj.sleepIsland != island) {
+                mergeIslands(obj.sleepIsland, island);
+            }
+        }
+    }
+}
@@ -1,6 +1,11 @@
 #pragma once
 #include "core/scene.hpp"
 #include <glm/glm.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
 #include "scene_object.hpp"
 
 class Physics {
@@ -8,22 +13,49 @@ public:
     Physics() =default;
     Physics(const std::vector<SceneObject>& objects);
     void update(float deltaTime);
-    void updateObject(SceneObject& obj);
+    void updateObject(SceneObject& obj, float deltaTime);
 
+    // Dynamic objects advance in steps of this size, independent of the
+    // frame time. Swept collisions keep large steps from tunneling.
+    void setFixedTimestep(float step) { fixedTimestep = std::max(step, 0.001f); }
+    float getFixedTimestep() const { return fixedTimestep; }
+
+    // The sphere the camera collides with and pushes. It mirrors the first
+    // dynamic sphere in the scene; every other body keeps its own state.
     const glm::vec3& getSpherePosition() const { return spherePosition; }
     const glm::vec3& getSphereVelocity() const { return sphereVelocity; }
-    void setSpherePosition(const glm::vec3& pos) { spherePosition = pos; }
-    void setSphereVelocity(const glm::vec3& vel) { sphereVelocity = vel; }
+    void setSpherePosition(const glm::vec3& pos) {
+        spherePosition = pos;
+        sphereDisturbed = true;
+    }
+    void setSphereVelocity(const glm::vec3& vel) {
+        sphereVelocity = vel;
+        sphereDisturbed = true;
+    }
 
     // Camera physics
     const glm::vec3& getCameraVelocity() const { return cameraVelocity; }
     void setCameraVelocity(const glm::vec3& vel) { cameraVelocity = vel; }
     void applyCameraForce(const glm::vec3& force);
     bool isCameraGrounded() const { return cameraGrounded; }
-    void updateCameraPosition(glm::vec3& position);
+    void updateCameraPosition(glm::vec3& position, float deltaTime);
     void setSceneObjects(const std::vector<SceneObject>& objects) {
         objectsInScene = &objects;
+        invalidateBodies();
     }
+    // Call when objects are added or removed so the active list is rebuilt
+    void invalidateBodies() { activeListValid = false; }
+    size_t getActiveBodyCount() const { return activeBodies.size(); }
+    // Heap bytes of the solver's own lists, not the objects it moves
+    size_t getMemoryUsage() const {
+        return activeBodies.capacity() * sizeof(size_t) +
+               contacts.capacity() * sizeof(std::pair<size_t, size_t>) +
+               islandParent.capacity() * sizeof(size_t) + islandBlocked.capacity() +
+               islandIds.capacity() * sizeof(uint32_t) +
+               sleepingIslands.size() * (sizeof(uint32_t) + sizeof(size_t));
+    }
+    // Wakes the body and every body of the island it fell asleep with
+    void wakeBody(SceneObject& obj);
 
 private:
     glm::vec3 spherePosition{0.0f, 0.0f, -1.0f};
@@ -40,11 +72,57 @@ private:
     const float RESTITUTION = 0.6f;
     const float FRICTION = 1.5f;
     const float AIR_RESISTANCE = 0.1f;
+    // Time-of-impact sub-steps per object step before the rest is dropped
+    static const int MAX_CCD_ITERATIONS = 4;
+    // Object steps per update before the accumulator is reset
+    static const int MAX_STEPS_PER_UPDATE = 8;
     const std::vector<SceneObject>* objectsInScene{nullptr};
+    float fixedTimestep{0.016f};
+    float accumulator{0.0f};
+
+    // Sleeping: a body that stays below SLEEP_SPEED for SLEEP_TIME is put to
+    // sleep together with every body it touches (its island). Only awake
+    // bodies are kept in activeBodies, which is all the step iterates. A
+    // sleeping island wakes as a whole, also when it loses a member.
+    const float SLEEP_SPEED = 0.05f;
+    const float SLEEP_TIME = 0.5f;
+    // Contacts faster than this wake a sleeping body
+    const float WAKE_SPEED = 0.2f;
+    // Impacts slower than this are treated as resting contact, no bounce
+    const float RESTING_SPEED = 0.3f;
+    std::vector<size_t> activeBodies;
+    bool activeListValid{false};
+    static constexpr size_t NO_BODY = static_cast<size_t>(-1);
+    size_t cameraBody{NO_BODY}; // object mirrored by spherePosition
+    std::vector<std::pair<size_t, size_t>> contacts; // touching bodies this step
+    std::vector<size_t> islandParent;
+    std::vector<char> islandBlocked;
+    std::vector<uint32_t> islandIds;          // sleep island given to each root this step
+    std::map<uint32_t, size_t> sleepingIslands; // members each sleeping island fell asleep with
+    uint32_t nextIsland{1};
+    bool sphereDisturbed{false}; // the camera pushed the sphere this frame
 
     void handleCollisions();
     bool checkSphereCollision(const glm::vec3& position, float radius);
     bool checkGroundCollision(const glm::vec3& position, float height);
     void updateDynamicObject(SceneObject& obj, float deltaTime);
     void handleObjectCollisions(SceneObject& obj);
+    struct SweepHit {
+        float fraction;   // of the swept displacement, 0..1
+        glm::vec3 normal; // pointing back towards the sphere
+        bool ground;
+        const SceneObject* other; // null for the static room
+    };
+    bool sweepSphere(const SceneObject& obj, const glm::vec3& displacement, float radius, SweepHit& hit) const;
+    void respondToImpact(SceneObject& obj, const SweepHit& hit, float radius);
+    std::vector<SceneObject>& sceneObjects() const {
+        return *const_cast<std::vector<SceneObject>*>(objectsInScene);
+    }
+    void rebuildActiveList();
+    void setAwake(SceneObject& obj);
+    void mergeIslands(uint32_t from, uint32_t into);
+    void wakeIncompleteIslands();
+    void recordContact(SceneObject& obj, const SceneObject& other);
+    size_t findIsland(size_t body);
+    void updateSleepStates(float deltaTime);
 };
@@ -0,0 +1,368 @@
+#include "render_cluster.hpp"
+#include "core/image_writer.hpp"
+#include "core/renderer.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <csignal>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+// Running this many times longer than the average tile counts as lagging
+const double LAG_FACTOR = 3.0;
+const int POLL_INTERVAL_MS = 20;
+
+enum MessageType : uint32_t {
+    MESSAGE_TILE = 1,   // TileRequest, FrameConstants, water state, GpuObject[]
+    MESSAGE_RESULT = 2  // TileRequest, RGBA8 rows bottom-up
+};
+
+struct MessageHeader {
+    uint32_t type;
+    uint32_t size;
+};
+
+struct TileRequest {
+    uint64_t frameIndex;
+    int32_t x, y, width, height;
+};
+
+bool writeAll(int socket, const void* data, size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t written = write(socket, bytes, size);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        bytes += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+bool readAll(int socket, void* data, size_t size) {
+    char* bytes = static_cast<char*>(data);
+    while (size > 0) {
+        ssize_t received = read(socket, bytes, size);
+        if (received < 0 && errno == EINTR) continue;
+        if (received <= 0) return false;
+        bytes += received;
+        size -= static_cast<size_t>(received);
+    }
+    return true;
+}
+
+bool sendMessage(int socket, uint32_t type, const std::vector<uint8_t>& payload) {
+    MessageHeader header{type, static_cast<uint32_t>(payload.size())};
+    return writeAll(socket, &header, sizeof(header)) && writeAll(socket, payload.data(), payload.size());
+}
+
+// False once the peer has closed the socket
+bool readMessage(int socket, MessageHeader& header, std::vector<uint8_t>& payload) {
+    if (!readAll(socket, &header, sizeof(header))) return false;
+    payload.resize(header.size);
+    return readAll(socket, payload.data(), payload.size());
+}
+
+void appendBytes(std::vector<uint8_t>& buffer, const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    buffer.insert(buffer.end(), bytes, bytes + size);
+}
+
+} // namespace
+
+int spawnRenderWorkers(int count, std::vector<RenderWorkerProcess>& workers) {
+    for (int i = 0; i < count; i++) {
+        int sockets[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0) {
+            throw std::runtime_error(std::string("Failed to create worker socket: ") + std::strerror(errno));
+        }
+        pid_t pid = fork();
+        if (pid < 0) {
+            close(sockets[0]);
+            close(sockets[1]);
+            throw std::runtime_error(std::string("Failed to start render worker: ") + std::strerror(errno));
+        }
+        if (pid == 0) {
+            // Only the worker's own end stays open in the child
+            close(sockets[0]);
+            for (const auto& worker : workers) {
+                close(worker.socket);
+            }
+            workers.clear();
+            return sockets[1];
+        }
+        close(sockets[1]);
+        workers.push_back({static_cast<int>(pid), sockets[0]});
+    }
+    return -1;
+}
+
+void runRenderWorker(int socket, Renderer& renderer) {
+    FrameSnapshot snapshot;
+    std::vector<uint8_t> payload;
+    std::vector<uint8_t> pixels;
+    MessageHeader header;
+    while (readMessage(socket, header, payload)) {
+        const size_t fixedSize = sizeof(TileRequest) + sizeof(FrameConstants) + WaterSimulation::STATE_SIZE;
+        if (header.type != MESSAGE_TILE || payload.size() < fixedSize ||
+            (payload.size() - fixedSize) % sizeof(GpuObject) != 0) {
+            throw std::runtime_error("Malformed tile request from render coordinator");
+        }
+        TileRequest request;
+        std::memcpy(&request, payload.data(), sizeof(request));
+        std::memcpy(&snapshot.constants, payload.data() + sizeof(request), sizeof(FrameConstants));
+        const uint8_t* waterState = payload.data() + sizeof(request) + sizeof(FrameConstants);
+        snapshot.waterState.assign(waterState, waterState + WaterSimulation::STATE_SIZE);
+        snapshot.objects.resize((payload.size() - fixedSize) / sizeof(GpuObject));
+        std::memcpy(snapshot.objects.data(), payload.data() + fixedSize, payload.size() - fixedSize);
+        snapshot.frameIndex = request.frameIndex;
+
+        const glm::ivec4 region(request.x, request.y, request.width, request.height);
+        renderer.setRenderRegion(region);
+        renderer.render(snapshot);
+        renderer.readPixels(region, pixels);
+
+        payload.clear();
+        appendBytes(payload, &request, sizeof(request));
+        appendBytes(payload, pixels.data(), pixels.size());
+        if (!sendMessage(socket, MESSAGE_RESULT, payload)) {
+            break;
+        }
+    }
+    close(socket);
+}
+
+RenderCoordinator::RenderCoordinator(std::vector<RenderWorkerProcess> processes, int width, int height,
+                                     RenderClusterSettings clusterSettings)
+    : width(width), height(height), settings(std::move(clusterSettings)) {
+    settings.tilesPerFrame = std::max(1, std::min(settings.tilesPerFrame, height));
+    for (const auto& process : processes) {
+        Worker worker;
+        worker.process = process;
+        workers.push_back(worker);
+    }
+    // A dead worker shows up as a failed write rather than killing us
+    std::signal(SIGPIPE, SIG_IGN);
+}
+
+RenderCoordinator::~RenderCoordinator() {
+    // Closing the sockets tells the workers to exit
+    for (auto& worker : workers) {
+        if (worker.process.socket >= 0) {
+            close(worker.process.socket);
+        }
+    }
+    for (auto& worker : workers) {
+        waitpid(worker.process.pid, nullptr, 0);
+    }
+}
+
+void RenderCoordinator::run(const FramePipeline::SimulateFunction& simulate) {
+    // Enough frames ahead that every worker can have a tile of its own
+    const size_t maxFramesAhead = workers.size() / settings.tilesPerFrame + 2;
+    uint64_t simulatedFrames = 0;
+    std::vector<pollfd> pollFds;
+    std::vector<Worker*> polledWorkers;
+
+    while (nextFrameToWrite < settings.frameCount) {
+        while (simulatedFrames < settings.frameCount && frames.size() < maxFramesAhead) {
+            InputFrame input;
+            input.deltaTime = settings.frameDeltaTime;
+            PendingFrame& frame = frames[simulatedFrames];
+            simulate(input, frame.snapshot);
+            frame.snapshot.frameIndex = simulatedFrames;
+            frame.pixels.resize(static_cast<size_t>(width) * height * 4);
+            frame.tileIssues.assign(settings.tilesPerFrame, 0);
+            frame.remainingTiles = settings.tilesPerFrame;
+            for (int tile = 0; tile < settings.tilesPerFrame; tile++) {
+                queue.emplace_back(simulatedFrames, tile);
+            }
+            simulatedFrames++;
+        }
+
+        for (auto& worker : workers) {
+            if (worker.busy || worker.process.socket < 0) continue;
+            if (!queue.empty()) {
+                auto next = queue.front();
+                queue.pop_front();
+                assign(worker, next.first, next.second);
+            } else {
+                reissueLaggingTile(worker);
+            }
+        }
+
+        pollFds.clear();
+        polledWorkers.clear();
+        for (auto& worker : workers) {
+            if (worker.busy) {
+                pollFds.push_back({worker.process.socket, POLLIN, 0});
+                polledWorkers.push_back(&worker);
+            }
+        }
+        if (pollFds.empty()) {
+            throw std::runtime_error("All render workers have exited");
+        }
+        if (poll(pollFds.data(), pollFds.size(), POLL_INTERVAL_MS) < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error(std::string("Polling render workers failed: ") + std::strerror(errno));
+        }
+        for (size_t i = 0; i < pollFds.size(); i++) {
+            if (pollFds[i].revents != 0) {
+                receive(*polledWorkers[i]);
+            }
+        }
+        writeFinishedFrames();
+    }
+}
+
+void RenderCoordinator::assign(Worker& worker, uint64_t frameIndex, int tile) {
+    PendingFrame& frame = frames.at(frameIndex);
+    const glm::ivec4 region = getTileRegion(tile);
+    TileRequest request{frameIndex, region.x, region.y, region.z, region.w};
+
+    std::vector<uint8_t> payload;
+    appendBytes(payload, &request, sizeof(request));
+    appendBytes(payload, &frame.snapshot.constants, sizeof(FrameConstants));
+    appendBytes(payload, frame.snapshot.waterState.data(), frame.snapshot.waterState.size());
+    appendBytes(payload, frame.snapshot.objects.data(), frame.snapshot.objects.size() * sizeof(GpuObject));
+
+    frame.tileIssues[tile]++;
+    worker.busy = true;
+    worker.frame = frameIndex;
+    worker.tile = tile;
+    worker.started = Clock::now();
+    if (!sendMessage(worker.process.socket, MESSAGE_TILE, payload)) {
+        retire(worker);
+    }
+}
+
+void RenderCoordinator::reissueLaggingTile(Worker& idle) {
+    if (completedTiles == 0) return;
+    const double averageSeconds = totalTileSeconds / completedTiles;
+    const Clock::time_point now = Clock::now();
+
+    Worker* lagging = nullptr;
+    double longestSeconds = LAG_FACTOR * averageSeconds;
+    for (auto& worker : workers) {
+        if (!worker.busy) continue;
+        auto frame = frames.find(worker.frame);
+        // Only the first copy of a tile is ever duplicated
+        if (frame == frames.end() || frame->second.tileIssues[worker.tile] != 1) continue;
+        double seconds = std::chrono::duration<double>(now - worker.started).count();
+        if (seconds > longestSeconds) {
+            longestSeconds = seconds;
+            lagging = &worker;
+        }
+    }
+    if (lagging) {
+        reissuedTiles++;
+        assign(idle, lagging->frame, lagging->tile);
+    }
+}
+
+void RenderCoordinator::receive(Worker& worker) {
+    MessageHeader header;
+    std::vector<uint8_t> payload;
+    if (!readMessage(worker.process.socket, header, payload) || header.type != MESSAGE_RESULT ||
+        payload.size() < sizeof(TileRequest)) {
+        retire(worker);
+        return;
+    }
+    totalTileSeconds += std::chrono::duration<double>(Clock::now() - worker.started).count();
+    completedTiles++;
+    worker.busy = false;
+
+    auto found = frames.find(worker.frame);
+    if (found == frames.end() || found->second.tileIssues[worker.tile] < 0) {
+        return; // another worker delivered this tile first
+    }
+    PendingFrame& frame = found->second;
+    const glm::ivec4 region = getTileRegion(worker.tile);
+    const size_t rowBytes = static_cast<size_t>(region.z) * 4;
+    if (payload.size() != sizeof(TileRequest) + rowBytes * region.w) {
+        throw std::runtime_error("Render worker returned a tile of the wrong size");
+    }
+    const uint8_t* rows = payload.data() + sizeof(TileRequest);
+    for (int y = 0; y < region.w; y++) {
+        std::memcpy(frame.pixels.data() + (static_cast<size_t>(region.y + y) * width + region.x) * 4,
+                    rows + y * rowBytes, rowBytes);
+    }
+    frame.tileIssues[worker.tile] = -1;
+    frame.remainingTiles--;
+}
+
+void RenderCoordinator::retire(Worker& worker) {
+    std::cerr << "Render worker " << worker.process.pid << " exited" << std::endl;
+    close(worker.process.socket);
+    worker.process.socket = -1;
+    if (worker.busy) {
+        worker.busy = false;
+        auto frame = frames.find(worker.frame);
+        // Re-queue the tile unless another copy is still out
+        if (frame != frames.end() && frame->second.tileIssues[worker.tile] > 0 &&
+            --frame->second.tileIssues[worker.tile] == 0) {
+            queue.emplace_front(worker.frame, worker.tile);
+        }
+    }
+}
+
+void RenderCoordinator::writeFinishedFrames() {
+    const size_t rowBytes = static_cast<size_t>(width) * 4;
+    std::vector<uint8_t> flipped(rowBytes * height);
+    while (!frames.empty() && frames.begin()->first == nextFrameToWrite &&
+           frames.begin()->second.remainingTiles == 0) {
+        // The output image is bottom-up, PNG rows are top-down
+        const std::vector<uint8_t>& pixels = frames.begin()->second.pixels;
+        for (int y = 0; y < height; y++) {
+            std::memcpy(flipped.data() + y * rowBytes, pixels.data() + (height - 1 - y) * rowBytes, rowBytes);
+        }
+        std::ostringstream path;
+        path << settings.outputPrefix << "_" << std::setw(6) << std::setfill('0') << nextFrameToWrite << ".png";
+        writePng(path.str(), width, height, flipped.data());
+
+        frames.erase(frames.begin());
+        nextFrameToWrite++;
+    }
+}
+
+glm::ivec4 RenderCoordinator::getTileRegion(int tile) const {
+    // Horizontal bands, the remainder spread over the first few
+    const int bandHeight = height / settings.tilesPerFrame;
+    const int remainder = height % settings.tilesPerFrame;
+    const int y = tile * bandHeight + std::min(tile, remainder);
+    return glm::ivec4(0, y, width, bandHeight + (tile < remainder ? 1 : 0));
+}
+
+#else
+
+int spawnRenderWorkers(int, std::vector<RenderWorkerProcess>&) {
+    throw std::runtime_error("Render workers need a POSIX host");
+}
+
+void runRenderWorker(int, Renderer&) {
+    throw std::runtime_error("Render workers need a POSIX host");
+}
+
+RenderCoordinator::RenderCoordinator(std::vector<RenderWorkerProcess>, int width, int height,
+                                     RenderClusterSettings clusterSettings)
+    : width(width), height(height), settings(std::move(clusterSettings)) {
+    throw std::runtime_error("Render workers need a POSIX host");
+}
+
+RenderCoordinator::~RenderCoordinator() {}
+
+void RenderCoordinator::run(const FramePipeline::SimulateFunction&) {}
+
+#endif
@@ -0,0 +1,92 @@
+#pragma once
+#include "core/frame_pipeline.hpp"
+#include "core/frame_snapshot.hpp"
+#include <glm/glm.hpp>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+class Renderer;
+
+// Offline rendering spread over local worker processes. The coordinator
+// simulates every frame once and sends each tile request together with the
+// frame's snapshot (camera, aging state, timestamp, water state and objects)
+// over a socket pair. Workers render just that tile headless and send its pixels
+// back; finished frames are stitched and written as a PNG sequence in order.
+// Messages use the host's native layout, so workers must share its build.
+// POSIX only; elsewhere spawning workers throws.
+
+struct RenderClusterSettings {
+    int tilesPerFrame{4};           // horizontal bands per frame
+    uint64_t frameCount{0};
+    float frameDeltaTime{1.0f / 30.0f};
+    std::string outputPrefix;       // frames go to <prefix>_000000.png ...
+};
+
+struct RenderWorkerProcess {
+    int pid;
+    int socket;
+};
+
+// Forks `count` worker processes. Must be called before GLFW or any other
+// thread starts. Returns the worker's socket in a child and -1 in the
+// coordinator, which gets the workers appended to `workers`.
+int spawnRenderWorkers(int count, std::vector<RenderWorkerProcess>& workers);
+
+// Serves tile requests until the coordinator closes the socket
+void runRenderWorker(int socket, Renderer& renderer);
+
+// Hands tiles to idle workers and re-issues a tile to an idle worker when
+// its first one takes far longer than tiles usually do; whichever copy
+// finishes first is used. A worker that dies has its tile re-queued.
+class RenderCoordinator {
+public:
+    RenderCoordinator(std::vector<RenderWorkerProcess> workers, int width, int height,
+                      RenderClusterSettings settings);
+    ~RenderCoordinator();
+
+    RenderCoordinator(const RenderCoordinator&) = delete;
+    RenderCoordinator& operator=(const RenderCoordinator&) = delete;
+
+    void run(const FramePipeline::SimulateFunction& simulate);
+
+    uint64_t getReissuedTiles() const { return reissuedTiles; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Worker {
+        RenderWorkerProcess process;
+        bool busy{false};
+        uint64_t frame{0};
+        int tile{0};
+        Clock::time_point started;
+    };
+
+    struct PendingFrame {
+        FrameSnapshot snapshot;
+        std::vector<uint8_t> pixels;   // RGBA8, bottom-up like the output image
+        std::vector<int> tileIssues;   // copies of each tile sent out, -1 once done
+        int remainingTiles{0};
+    };
+
+    std::vector<Worker> workers;
+    int width, height;
+    RenderClusterSettings settings;
+    std::map<uint64_t, PendingFrame> frames;
+    std::deque<std::pair<uint64_t, int>> queue; // (frame, tile) not yet sent
+    uint64_t nextFrameToWrite{0};
+    uint64_t reissuedTiles{0};
+    double totalTileSeconds{0.0};
+    uint64_t completedTiles{0};
+
+    void assign(Worker& worker, uint64_t frame, int tile);
+    void reissueLaggingTile(Worker& idle);
+    void receive(Worker& worker);
+    void retire(Worker& worker);
+    void writeFinishedFrames();
+    glm::ivec4 getTileRegion(int tile) const;
+};
@@ -0,0 +1,372 @@
+#include "render_server.hpp"
+#include "core/image_writer.hpp"
+#include "core/renderer.hpp"
+#include "core/scene_streamer.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <csignal>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+bool parseVec3(const std::string& text, glm::vec3& v) {
+    std::istringstream in(text);
+    char comma1 = 0, comma2 = 0;
+    in >> v.x >> comma1 >> v.y >> comma2 >> v.z;
+    return !in.fail() && comma1 == ',' && comma2 == ',' && in.peek() == std::char_traits<char>::eof();
+}
+
+bool parseFloat(const std::string& text, float& value) {
+    std::istringstream in(text);
+    in >> value;
+    return !in.fail() && in.peek() == std::char_traits<char>::eof();
+}
+
+double millisecondsBetween(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+} // namespace
+
+bool parseRenderJob(const std::string& line, RenderJob& job, std::string& error) {
+    std::istringstream in(line);
+    std::string field;
+    while (in >> field) {
+        size_t equals = field.find('=');
+        if (equals == std::string::npos) {
+            error = "expected key=value, got " + field;
+            return false;
+        }
+        const std::string key = field.substr(0, equals);
+        const std::string value = field.substr(equals + 1);
+        bool valid = true;
+        if (key == "id") {
+            job.id = value;
+        } else if (key == "scene") {
+            job.scenePath = value;
+        } else if (key == "output") {
+            job.outputPath = value;
+        } else if (key == "camera") {
+            valid = job.hasCamera = parseVec3(value, job.cameraPosition);
+        } else if (key == "target") {
+            valid = job.hasTarget = parseVec3(value, job.cameraTarget);
+        } else if (key == "rust") {
+            valid = parseFloat(value, job.rustLevel);
+        } else if (key == "age") {
+            valid = parseFloat(value, job.age);
+        } else if (key == "moisture") {
+            valid = parseFloat(value, job.moisture);
+        } else if (key == "time") {
+            valid = parseFloat(value, job.time);
+        } else {
+            error = "unknown field " + key;
+            return false;
+        }
+        if (!valid) {
+            error = "bad value for " + key + ": " + value;
+            return false;
+        }
+    }
+    if (job.outputPath.empty()) {
+        error = "missing output";
+        return false;
+    }
+    return true;
+}
+
+#ifndef _WIN32
+
+RenderServer::RenderServer(Renderer& renderer, const std::string& endpoint)
+    : renderer(renderer), endpoint(endpoint) {
+    if (endpoint == "-") {
+        connections[nextConnectionId++] = {STDIN_FILENO, STDOUT_FILENO, {}, false, false};
+        return;
+    }
+
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (endpoint.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Render server socket path too long: " + endpoint);
+    }
+    std::strcpy(address.sun_path, endpoint.c_str());
+    listenSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenSocket < 0) {
+        throw std::runtime_error("Failed to create render server socket");
+    }
+    unlink(endpoint.c_str()); // left behind by a server that did not shut down
+    if (bind(listenSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(listenSocket, 16) != 0) {
+        close(listenSocket);
+        throw std::runtime_error("Failed to listen on " + endpoint + ": " + std::strerror(errno));
+    }
+    // A client that hangs up early shows up as a failed write
+    std::signal(SIGPIPE, SIG_IGN);
+}
+
+RenderServer::~RenderServer() {
+    if (listenSocket >= 0) {
+        for (auto& entry : connections) {
+            if (!entry.second.closed) close(entry.second.input);
+        }
+        close(listenSocket);
+        unlink(endpoint.c_str());
+    }
+}
+
+void RenderServer::run() {
+    defaultObjects = renderer.getScene().getObjects();
+    defaultCameraPosition = renderer.getCamera().getPosition();
+    defaultCameraTarget = defaultCameraPosition + renderer.getCamera().getFront();
+    while (true) {
+        receive(queue.empty() && !stopping);
+        if (!queue.empty()) {
+            runBatch();
+        } else if (stopping) {
+            break;
+        }
+        removeClosedConnections();
+    }
+}
+
+void RenderServer::receive(bool wait) {
+    std::vector<pollfd> pollFds;
+    std::vector<uint64_t> pollConnections;
+    if (listenSocket >= 0) {
+        pollFds.push_back({listenSocket, POLLIN, 0});
+    }
+    for (const auto& entry : connections) {
+        if (!entry.second.finished && !entry.second.closed) {
+            pollFds.push_back({entry.second.input, POLLIN, 0});
+            pollConnections.push_back(entry.first);
+        }
+    }
+    if (pollFds.empty()) {
+        stopping = true;
+        return;
+    }
+    if (poll(pollFds.data(), pollFds.size(), wait ? -1 : 0) <= 0) {
+        return;
+    }
+
+    size_t first = 0;
+    if (listenSocket >= 0) {
+        first = 1;
+        if (pollFds[0].revents & POLLIN) {
+            int client = accept(listenSocket, nullptr, nullptr);
+            if (client >= 0) {
+                connections[nextConnectionId++] = {client, client, {}, false, false};
+            }
+        }
+    }
+    for (size_t i = first; i < pollFds.size(); i++) {
+        if (pollFds[i].revents & (POLLIN | POLLHUP | POLLERR)) {
+            readConnection(pollConnections[i - first]);
+        }
+    }
+}
+
+void RenderServer::readConnection(uint64_t id) {
+    Connection& connection = connections.at(id);
+    char data[4096];
+    ssize_t count = read(connection.input, data, sizeof(data));
+    if (count <= 0) {
+        if (count < 0 && errno == EINTR) return;
+        if (listenSocket < 0) {
+            stopping = true; // end of stdin
+        }
+        // A client may shut down its write half and still wait for replies
+        connection.finished = true;
+        return;
+    }
+    connection.buffer.append(data, static_cast<size_t>(count));
+    size_t newline;
+    while ((newline = connection.buffer.find('\n')) != std::string::npos) {
+        std::string line = connection.buffer.substr(0, newline);
+        connection.buffer.erase(0, newline + 1);
+        handleLine(id, line);
+    }
+}
+
+void RenderServer::removeClosedConnections() {
+    for (auto it = connections.begin(); it != connections.end();) {
+        const uint64_t id = it->first;
+        const bool waiting = std::any_of(queue.begin(), queue.end(),
+                                         [id](const QueuedJob& queued) { return queued.connection == id; });
+        if ((it->second.finished || it->second.closed) && !waiting) {
+            if (listenSocket >= 0 && !it->second.closed) {
+                close(it->second.input);
+            }
+            it = connections.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void RenderServer::handleLine(uint64_t connection, const std::string& line) {
+    const size_t start = line.find_first_not_of(" \t\r");
+    if (start == std::string::npos || line[start] == '#') {
+        return;
+    }
+    if (line.compare(start, 4, "quit") == 0) {
+        stopping = true;
+        return;
+    }
+
+    QueuedJob queued;
+    queued.connection = connection;
+    queued.received = Clock::now();
+    std::string error;
+    bool valid = parseRenderJob(line, queued.job, error);
+    if (queued.job.id.empty()) {
+        queued.job.id = std::to_string(nextJobId++);
+    }
+    if (stopping) {
+        reply(queued.connection, "error " + queued.job.id + " server is stopping");
+    } else if (!valid) {
+        failedJobs++;
+        reply(queued.connection, "error " + queued.job.id + " " + error);
+    } else {
+        queue.push_back(std::move(queued));
+    }
+}
+
+void RenderServer::runBatch() {
+    std::vector<QueuedJob> batch;
+    batch.swap(queue);
+    // The scene that is already loaded goes first, then one load per scene
+    std::stable_sort(batch.begin(), batch.end(), [this](const QueuedJob& a, const QueuedJob& b) {
+        bool aLoaded = a.job.scenePath == loadedScene;
+        bool bLoaded = b.job.scenePath == loadedScene;
+        if (aLoaded != bLoaded) return aLoaded;
+        return a.job.scenePath < b.job.scenePath;
+    });
+    for (const auto& queued : batch) {
+        runJob(queued);
+    }
+}
+
+void RenderServer::runJob(const QueuedJob& queued) {
+    const RenderJob& job = queued.job;
+    const Clock::time_point start = Clock::now();
+    try {
+        loadScene(job.scenePath);
+        const Clock::time_point loaded = Clock::now();
+
+        renderer.setRustLevel(job.rustLevel);
+        renderer.setAge(job.age);
+        renderer.setMoisture(job.moisture);
+        Camera& camera = renderer.getCamera();
+        camera.setPosition(job.hasCamera ? job.cameraPosition : defaultCameraPosition);
+        camera.lookAt(job.hasTarget ? job.cameraTarget : defaultCameraTarget);
+
+        FrameSnapshot snapshot;
+        renderer.captureSnapshot(snapshot);
+        snapshot.constants.time = job.time;
+        snapshot.water = WaterForcing(); // stills, the water holds its state
+        renderer.setRenderRegion(glm::ivec4(0));
+        renderer.render(snapshot);
+        glFinish();
+        const Clock::time_point rendered = Clock::now();
+
+        const int width = renderer.getWidth();
+        const int height = renderer.getHeight();
+        renderer.readPixels(glm::ivec4(0, 0, width, height), pixels);
+        const Clock::time_point readBack = Clock::now();
+
+        // The output image is bottom-up, PNG rows are top-down
+        const size_t rowBytes = static_cast<size_t>(width) * 4;
+        flipped.resize(pixels.size());
+        for (int y = 0; y < height; y++) {
+            std::memcpy(flipped.data() + y * rowBytes, pixels.data() + (height - 1 - y) * rowBytes, rowBytes);
+        }
+        writePng(job.outputPath, width, height, flipped.data());
+        const Clock::time_point written = Clock::now();
+
+        std::ostringstream message;
+        message << std::fixed << std::setprecision(2) << "done " << job.id << " " << job.outputPath
+                << " wait_ms=" << millisecondsBetween(queued.received, start)
+                << " scene_ms=" << millisecondsBetween(start, loaded)
+                << " render_ms=" << millisecondsBetween(loaded, rendered)
+                << " readback_ms=" << millisecondsBetween(rendered, readBack)
+                << " write_ms=" << millisecondsBetween(readBack, written);
+        completedJobs++;
+        reply(queued.connection, message.str());
+    } catch (const std::exception& e) {
+        failedJobs++;
+        reply(queued.connection, "error " + job.id + " " + e.what());
+    }
+}
+
+void RenderServer::loadScene(const std::string& path) {
+    if (path == loadedScene) {
+        return;
+    }
+    const std::vector<SceneObject>* objects = &defaultObjects;
+    if (!path.empty()) {
+        auto cached = sceneCache.find(path);
+        if (cached == sceneCache.end()) {
+            std::vector<SceneObject> loaded;
+            if (!readSceneFile(path, loaded)) {
+                throw std::runtime_error("cannot open scene " + path);
+            }
+            cached = sceneCache.emplace(path, std::move(loaded)).first;
+        }
+        objects = &cached->second;
+    }
+
+    Scene& scene = renderer.getScene();
+    scene.takeObjects([](const SceneObject&) { return true; });
+    for (const auto& obj : *objects) {
+        scene.addObject(obj);
+    }
+    loadedScene = path;
+}
+
+void RenderServer::reply(uint64_t connection, const std::string& message) {
+    auto found = connections.find(connection);
+    if (found == connections.end()) {
+        return;
+    }
+    Connection& target = found->second;
+    if (target.closed) {
+        return;
+    }
+    const std::string line = message + "\n";
+    size_t written = 0;
+    while (written < line.size()) {
+        ssize_t count = write(target.output, line.data() + written, line.size() - written);
+        if (count < 0 && errno == EINTR) continue;
+        if (count <= 0) {
+            if (listenSocket >= 0) {
+                close(target.input);
+            }
+            target.closed = true;
+            return;
+        }
+        written += static_cast<size_t>(count);
+    }
+}
+
+#else
+
+RenderServer::RenderServer(Renderer& renderer, const std::string& endpoint)
+    : renderer(renderer), endpoint(endpoint) {}
+
+RenderServer::~RenderServer() = default;
+
+void RenderServer::run() {
+    throw std::runtime_error("The render server needs a POSIX host");
+}
+
+#endif
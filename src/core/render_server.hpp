@@ -0,0 +1,106 @@
+#pragma once
+#include "core/scene_object.hpp"
+#include <glm/glm.hpp>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+class Renderer;
+
+// One render request. Jobs arrive as text lines of space separated
+// key=value fields, all optional except output:
+//   id=<name> scene=<file> camera=x,y,z target=x,y,z rust=<0..1> age=<0..1>
+//   moisture=<0..1> time=<s> output=<file.png>
+// Without scene= the renderer's startup scene is used; scene files use the
+// SceneStreamer cell format.
+struct RenderJob {
+    std::string id;
+    std::string scenePath;
+    bool hasCamera{false};
+    glm::vec3 cameraPosition{0.0f};
+    bool hasTarget{false};
+    glm::vec3 cameraTarget{0.0f};
+    float rustLevel{0.0f};
+    float age{0.0f};
+    float moisture{0.0f};
+    float time{0.0f};
+    std::string outputPath;
+};
+
+// Parses one request line; `error` says why when it returns false
+bool parseRenderJob(const std::string& line, RenderJob& job, std::string& error);
+
+// Long-lived render server around one warm renderer, so a parameter sweep
+// pays for context creation, shader compilation and texture decode once.
+// Requests come from stdin ("-") or from any number of clients of a Unix
+// socket. Everything that has arrived is taken as one batch, grouped by
+// scene file so each scene is loaded once per batch, and rendered in turn.
+// Each job is answered on its own connection with
+//   done <id> <output> wait_ms=.. scene_ms=.. render_ms=.. readback_ms=.. write_ms=..
+// or `error <id> <reason>`. A `quit` line stops the server once the jobs
+// queued before it are done; on stdin end of input does the same.
+// POSIX only; elsewhere run() throws.
+class RenderServer {
+public:
+    RenderServer(Renderer& renderer, const std::string& endpoint);
+    ~RenderServer();
+
+    RenderServer(const RenderServer&) = delete;
+    RenderServer& operator=(const RenderServer&) = delete;
+
+    void run();
+
+    uint64_t getCompletedJobs() const { return completedJobs; }
+    uint64_t getFailedJobs() const { return failedJobs; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Connection {
+        int input;
+        int output;
+        std::string buffer;  // bytes after the last complete line
+        bool finished{false}; // end of input; stays open to answer its jobs
+        bool closed{false};   // a reply failed and the socket is closed
+    };
+
+    struct QueuedJob {
+        RenderJob job;
+        uint64_t connection; // key into connections
+        Clock::time_point received;
+    };
+
+    Renderer& renderer;
+    std::string endpoint;
+    int listenSocket{-1};
+    // Keyed by an id that stays valid for queued jobs while others come and
+    // go; finished connections are closed once their jobs are answered
+    std::map<uint64_t, Connection> connections;
+    uint64_t nextConnectionId{0};
+    std::vector<QueuedJob> queue;
+    bool stopping{false};
+    uint64_t nextJobId{1};
+    uint64_t completedJobs{0};
+    uint64_t failedJobs{0};
+
+    std::vector<SceneObject> defaultObjects;
+    glm::vec3 defaultCameraPosition{0.0f};
+    glm::vec3 defaultCameraTarget{0.0f};
+    std::map<std::string, std::vector<SceneObject>> sceneCache;
+    std::string loadedScene;
+    std::vector<uint8_t> pixels;
+    std::vector<uint8_t> flipped;
+
+    // Waits for input when idle, otherwise only takes what is ready
+    void receive(bool wait);
+    void readConnection(uint64_t id);
+    void handleLine(uint64_t connection, const std::string& line);
+    void removeClosedConnections();
+    void runBatch();
+    void runJob(const QueuedJob& queued);
+    // Swaps the renderer's objects for the job's scene unless already loaded
+    void loadScene(const std::string& path);
+    void reply(uint64_t connection, const std::string& message);
+};
@@ -1,11 +1,89 @@
 #include "renderer.hpp"
+#include "memory_tracker.hpp"
+#include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <glm/gtc/type_ptr.hpp>
 #include <iostream>
 #include <sstream>
 
-Renderer::Renderer(int w, int h)
-    : width(w), height(h), camera(physics), scene(physics) {
+namespace {
+
+struct OutputFormatInfo {
+  const char *name;
+  GLenum internalFormat;
+  GLenum pixelFormat;
+  GLenum pixelType;
+  const char *imageQualifier; // GLSL layout format qualifier
+  size_t bytesPerPixel;
+};
+
+const OutputFormatInfo &getOutputFormatInfo(OutputFormat format) {
+  static const OutputFormatInfo infos[] = {
+      {"rgba32f", GL_RGBA32F, GL_RGBA, GL_FLOAT, "rgba32f", 16},
+      {"rgba8", GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, "rgba8", 4},
+      {"rgb10a2", GL_RGB10_A2, GL_RGBA, GL_UNSIGNED_INT_2_10_10_10_REV,
+       "rgb10_a2", 4},
+      {"r11g11b10f", GL_R11F_G11F_B10F, GL_RGB,
+       GL_UNSIGNED_INT_10F_11F_11F_REV, "r11f_g11f_b10f", 4},
+  };
+  return infos[static_cast<int>(format)];
+}
+
+} // namespace
+
+glm::ivec2 DispatchConfig::tileSize() const {
+  if (!mortonOrder) {
+    return glm::ivec2(localSizeX, localSizeY);
+  }
+  // Z order splits the invocation index bits between x (even) and y (odd)
+  int invocations = localSizeX * localSizeY;
+  int bits = 0;
+  while ((1 << (bits + 1)) <= invocations) {
+    bits++;
+  }
+  int tileWidth = 1 << ((bits + 1) / 2);
+  return glm::ivec2(tileWidth, (1 << bits) / tileWidth);
+}
+
+std::string DispatchConfig::toString() const {
+  return std::to_string(localSizeX) + "x" + std::to_string(localSizeY) +
+         (mortonOrder ? "/morton" : "/linear");
+}
+
+bool DispatchConfig::parse(const std::string &text, DispatchConfig &config) {
+  DispatchConfig parsed;
+  size_t x = text.find('x');
+  if (x == std::string::npos) {
+    return false;
+  }
+  size_t slash = text.find('/', x);
+  try {
+    parsed.localSizeX = std::stoi(text.substr(0, x));
+    parsed.localSizeY = std::stoi(text.substr(x + 1, slash - x - 1));
+  } catch (const std::exception &) {
+    return false;
+  }
+  if (slash != std::string::npos) {
+    std::string order = text.substr(slash + 1);
+    if (order == "morton") {
+      parsed.mortonOrder = true;
+    } else if (order != "linear") {
+      return false;
+    }
+  }
+  int invocations = parsed.localSizeX * parsed.localSizeY;
+  if (parsed.localSizeX <= 0 || parsed.localSizeY <= 0 ||
+      (parsed.mortonOrder && (invocations & (invocations - 1)) != 0)) {
+    return false;
+  }
+  config = parsed;
+  return true;
+}
+
+Renderer::Renderer(int w, int h, OutputFormat format)
+    : width(w), height(h), outputFormat(format), camera(physics),
+      scene(physics) {
   init();
 
   scene.addObject(ObjectType::GROUND, glm::vec3(0.0f, -1.0f, 0.0f), false);
@@ -15,9 +93,21 @@ Renderer::Renderer(int w, int h)
 }
 
 Renderer::~Renderer() {
+  MemoryTracker &memory = MemoryTracker::get();
+  memory.releaseTexture(outputTexture);
+  memory.releaseBuffer(objectBuffer);
+  memory.releaseTexture(viewArrayTexture);
+  memory.releaseBuffer(viewBuffer);
+  memory.releaseTexture(paintingTexture);
   glDeleteProgram(computeProgram);
   glDeleteTextures(1, &outputTexture);
+  glDeleteFramebuffers(1, &outputFramebuffer);
   glDeleteBuffers(1, &objectBuffer);
+  glDeleteProgram(multiViewProgram);
+  glDeleteTextures(1, &viewArrayTexture);
+  glDeleteFramebuffers(1, &viewFramebuffer);
+  glDeleteBuffers(1, &viewBuffer);
+  glDeleteTextures(1, &paintingTexture);
 }
 
 void Renderer::init() {
@@ -25,41 +115,27 @@ void Renderer::init() {
   createOutputTexture();
   loadPaintingTexture("textures/painting.jpg");
 
-  // Create and initialize object buffer
+  // Create and initialize object buffer; uploadObjects grows it on demand
   glGenBuffers(1, &objectBuffer);
   glBindBuffer(GL_SHADER_STORAGE_BUFFER, objectBuffer);
-  // Initialize with some space
-  glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(glm::vec4) * 100, nullptr,
-               GL_DYNAMIC_DRAW);
+  objectCapacity = 64;
+  glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GpuObject) * objectCapacity,
+               nullptr, GL_DYNAMIC_DRAW);
   glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, objectBuffer);
+  MemoryTracker::get().trackBuffer(objectBuffer,
+                                   sizeof(GpuObject) * objectCapacity,
+                                   MemoryCategory::SceneBuffers);
 
-  // Get uniform locations
-  rustLevelLoc = glGetUniformLocation(computeProgram, "rustLevel");
-  ageLoc = glGetUniformLocation(computeProgram, "age");
-  frameWidthLoc = glGetUniformLocation(computeProgram, "frameWidth");
-  cameraPositionLoc = glGetUniformLocation(computeProgram, "cameraPosition");
-  cameraFrontLoc = glGetUniformLocation(computeProgram, "cameraFront");
-  cameraUpLoc = glGetUniformLocation(computeProgram, "cameraUp");
-  numObjectsLoc = glGetUniformLocation(computeProgram, "numObjects");
-  moistureLoc = glGetUniformLocation(computeProgram, "moisture");
-  lightDirLoc = glGetUniformLocation(computeProgram, "lightDirection");
-  lightIntensityLoc = glGetUniformLocation(computeProgram, "lightIntensity");
+  // Per-frame parameters live in a ring of uniform block slots
+  frameConstantsRing = std::make_unique<UniformRing>(sizeof(FrameConstants));
+  latchedCameraRing = std::make_unique<UniformRing>(sizeof(LatchedCamera));
 
-  if (lightDirLoc == -1 || lightIntensityLoc == -1) {
-    throw std::runtime_error("Could not find light uniforms");
-  }
-  if (moistureLoc == -1) {
-    throw std::runtime_error("Could not find moisture uniform");
-  }
-  // Check all uniform locations
-  if (rustLevelLoc == -1 || ageLoc == -1 || frameWidthLoc == -1 ||
-      cameraPositionLoc == -1 || cameraFrontLoc == -1 || cameraUpLoc == -1 ||
-      numObjectsLoc == -1) {
-    throw std::runtime_error("Could not find shader uniforms");
-  }
+  water = std::make_unique<WaterSimulation>();
 }
 
 void Renderer::createOutputTexture() {
+  const OutputFormatInfo &info = getOutputFormatInfo(outputFormat);
+
   glGenTextures(1, &outputTexture);
   glActiveTexture(GL_TEXTURE0);
   glBindTexture(GL_TEXTURE_2D, outputTexture);
@@ -67,47 +143,447 @@ void Renderer::createOutputTexture() {
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, width, height, 0, GL_RGBA,
-               GL_FLOAT, NULL);
+  glTexImage2D(GL_TEXTURE_2D, 0, info.internalFormat, width, height, 0,
+               info.pixelFormat, info.pixelType, NULL);
+  MemoryTracker::get().trackTexture(
+      outputTexture, static_cast<size_t>(width) * height * info.bytesPerPixel,
+      MemoryCategory::OutputImage);
   glBindImageTexture(0, outputTexture, 0, GL_FALSE, 0, GL_WRITE_ONLY,
-                     GL_RGBA32F);
+                     info.internalFormat);
+
+  // Read framebuffer used by blitToScreen
+  glGenFramebuffers(1, &outputFramebuffer);
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, outputFramebuffer);
+  glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                         GL_TEXTURE_2D, outputTexture, 0);
+  if (glCheckFramebufferStatus(GL_READ_FRAMEBUFFER) !=
+      GL_FRAMEBUFFER_COMPLETE) {
+    throw std::runtime_error("Output framebuffer is incomplete");
+  }
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
 }
 
-void Renderer::render() {
-  // Update object data buffer
-  objectData.clear();
-  const auto &objects = scene.getObjects();
-  for (const auto &obj : objects) {
-    objectData.push_back(glm::vec4(
-        obj.position, static_cast<float>(static_cast<int>(obj.type))));
+void Renderer::setDispatchConfig(const DispatchConfig &config) {
+  // Compile first so a rejected shape leaves the current program intact
+  DispatchConfig previous = dispatchConfig;
+  dispatchConfig = config;
+  GLuint program;
+  try {
+    program = buildComputeProgram(getSingleViewDefines());
+  } catch (...) {
+    dispatchConfig = previous;
+    throw;
   }
 
-  // Update storage buffer
+  installComputeProgram(program);
+  glDeleteProgram(multiViewProgram);
+  multiViewProgram = 0;
+}
+
+void Renderer::setCameraLatch(CameraLatch latch) {
+  bool wasLatched = static_cast<bool>(cameraLatch);
+  cameraLatch = std::move(latch);
+  if (wasLatched != static_cast<bool>(cameraLatch)) {
+    installComputeProgram(buildComputeProgram(getSingleViewDefines()));
+  }
+}
+
+void Renderer::setObjectBinning(bool enabled) {
+  if (enabled == objectBinning) {
+    return;
+  }
+  objectBinning = enabled;
+  installComputeProgram(buildComputeProgram(getSingleViewDefines()));
+}
+
+void Renderer::setAdaptiveSampling(int extraSamples,
+                                   float contrastThreshold) {
+  extraSamples = std::max(extraSamples, 0);
+  adaptiveThreshold = glm::max(contrastThreshold, 0.0f);
+  if ((extraSamples > 0) == (adaptiveSamples > 0)) {
+    adaptiveSamples = extraSamples;
+    return;
+  }
+  adaptiveSamples = extraSamples;
+  installComputeProgram(buildComputeProgram(getSingleViewDefines()));
+}
+
+void Renderer::setPerfCounters(bool enabled) {
+  if (enabled == perfCountersEnabled) {
+    return;
+  }
+  perfCountersEnabled = enabled;
+  installComputeProgram(buildComputeProgram(getSingleViewDefines()));
+}
+
+void Renderer::setDebris(int count, float radius) {
+  debris.reset();
+  if (count > 0) {
+    debris = std::make_unique<GpuPhysics>(count, radius);
+  }
+}
+
+void Renderer::setRenderPath(RenderPath path) {
+  if (path == RenderPath::Wavefront && !wavefront) {
+    wavefront = std::make_unique<WavefrontPipeline>(
+        width, height, getOutputFormatInfo(outputFormat).imageQualifier);
+  }
+  renderPath = path;
+}
+
+bool Renderer::parseOutputFormat(const std::string &name,
+                                 OutputFormat &format) {
+  for (OutputFormat candidate :
+       {OutputFormat::RGBA32F, OutputFormat::RGBA8, OutputFormat::RGB10_A2,
+        OutputFormat::R11G11B10F}) {
+    if (name == getOutputFormatInfo(candidate).name) {
+      format = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+void Renderer::blitToScreen(int screenWidth, int screenHeight) {
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, outputFramebuffer);
+  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+  GLenum filter = (screenWidth == width && screenHeight == height)
+                      ? GL_NEAREST
+                      : GL_LINEAR;
+  glBlitFramebuffer(0, 0, width, height, 0, 0, screenWidth, screenHeight,
+                    GL_COLOR_BUFFER_BIT, filter);
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+}
+
+void Renderer::reserveObjectBuffer(size_t count) {
   glBindBuffer(GL_SHADER_STORAGE_BUFFER, objectBuffer);
-  glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0,
-                  objectData.size() * sizeof(glm::vec4), objectData.data());
-  glUseProgram(computeProgram);
-  // Update scene uniforms
+  // Debris records follow the scene's and are rewritten on the GPU
+  const size_t required = count + static_cast<size_t>(getDebrisCount());
+  if (required > objectCapacity) {
+    while (objectCapacity < required) {
+      objectCapacity *= 2;
+    }
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GpuObject) * objectCapacity,
+                 nullptr, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, objectBuffer);
+    MemoryTracker::get().trackBuffer(objectBuffer,
+                                     sizeof(GpuObject) * objectCapacity,
+                                     MemoryCategory::SceneBuffers);
+  }
+}
+
+GpuObject *Renderer::mapObjectBuffer(size_t count) {
+  reserveObjectBuffer(count);
+
+  // Invalidating lets the driver hand out fresh storage instead of waiting
+  // for frames still reading the old contents
+  auto *records = static_cast<GpuObject *>(glMapBufferRange(
+      GL_SHADER_STORAGE_BUFFER, 0, sizeof(GpuObject) * count,
+      GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+  if (!records) {
+    throw std::runtime_error("Failed to map object buffer");
+  }
+  return records;
+}
+
+void Renderer::uploadObjects() {
+  const auto &objects = scene.getObjects();
+  if (objects.empty()) {
+    return;
+  }
+  // Pack straight into the buffer
+  GpuObject *records = mapObjectBuffer(objects.size());
+  for (size_t i = 0; i < objects.size(); i++) {
+    packGpuObject(objects[i], records[i]);
+  }
+  glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+}
+
+void Renderer::uploadObjects(const std::vector<GpuObject> &records) {
+  if (records.empty()) {
+    return;
+  }
+  GpuObject *mapped = mapObjectBuffer(records.size());
+  std::memcpy(mapped, records.data(), sizeof(GpuObject) * records.size());
+  glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+}
+
+FrameConstants Renderer::buildFrameConstants() const {
+  FrameConstants constants;
+  constants.cameraPosition = camera.getPosition();
+  constants.rustLevel = rustLevel;
+  constants.cameraFront = camera.getFront();
+  constants.age = age;
+  constants.cameraUp = camera.getUp();
+  constants.frameWidth = frameWidth;
+  constants.lightDirection = lightDirection;
+  constants.lightIntensity = lightIntensity;
+  constants.moisture = moisture;
+  constants.time = currentTime;
+  constants.numObjects = static_cast<int32_t>(scene.getObjects().size());
+  constants.lodScale = lodScale;
+  return constants;
+}
+
+void Renderer::captureSnapshot(FrameSnapshot &snapshot) {
+  snapshot.constants = buildFrameConstants();
+  snapshot.water.deltaTime = lastDeltaTime;
+  snapshot.water.rainIntensity = rainIntensity;
+  snapshot.water.impacts.clear();
+  std::swap(snapshot.water.impacts, pendingWaterImpacts);
+  const auto &objects = scene.getObjects();
+  snapshot.objects.resize(objects.size());
+  for (size_t i = 0; i < objects.size(); i++) {
+    packGpuObject(objects[i], snapshot.objects[i]);
+  }
+}
+
+void Renderer::pushFrameConstants(const FrameConstants &constants) {
   glActiveTexture(GL_TEXTURE1);
   glBindTexture(GL_TEXTURE_2D, paintingTexture);
+  water->bindState();
+  frameConstantsRing->push(&constants, FRAME_CONSTANTS_BINDING);
+}
 
-  glUniform1i(numObjectsLoc, static_cast<GLint>(objects.size()));
-  glUniform1f(rustLevelLoc, rustLevel);
-  glUniform1f(ageLoc, age);
-  glUniform1f(frameWidthLoc, frameWidth);
-  glUniform3fv(cameraPositionLoc, 1, glm::value_ptr(camera.getPosition()));
-  glUniform3fv(cameraFrontLoc, 1, glm::value_ptr(camera.getFront()));
-  glUniform3fv(cameraUpLoc, 1, glm::value_ptr(camera.getUp()));
-  glUniform1f(moistureLoc, moisture);
-  glUniform1f(iTimeLoc, currentTime);
-  glUniform3fv(lightDirLoc, 1, glm::value_ptr(lightDirection));
-  glUniform1f(lightIntensityLoc, lightIntensity);
+void Renderer::render() {
+  uploadObjects();
+  FrameConstants constants = buildFrameConstants();
+  simulateDebris(lastDeltaTime, constants);
+  trace(constants);
+}
 
-  // Dispatch compute shader
-  glDispatchCompute((width + 7) / 8, (height + 7) / 8, 1);
+void Renderer::render(const FrameSnapshot &snapshot) {
+  updateWater(snapshot);
+  uploadObjects(snapshot.objects);
+  FrameConstants constants = snapshot.constants;
+  simulateDebris(snapshot.water.deltaTime, constants);
+  trace(constants);
+}
 
-  // Make sure writing to image has finished before read
-  glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+void Renderer::stepWater(FrameSnapshot &snapshot) {
+  stepWater(snapshot.water);
+  water->readState(snapshot.waterState);
+}
+
+void Renderer::updateWater(const FrameSnapshot &snapshot) {
+  if (snapshot.waterState.empty()) {
+    stepWater(snapshot.water);
+  } else {
+    water->loadState(snapshot.waterState);
+  }
+}
+
+void Renderer::stepWater(const WaterForcing &forcing) {
+  if (!debris) {
+    water->step(forcing);
+    return;
+  }
+  WaterForcing withDebris = forcing;
+  debris->collectImpacts(withDebris.impacts);
+  water->step(withDebris);
+}
+
+void Renderer::simulateDebris(float deltaTime, FrameConstants &constants) {
+  if (!debris) {
+    return;
+  }
+  // Scene records were just uploaded, so debris can collide with them
+  reserveObjectBuffer(static_cast<size_t>(constants.numObjects));
+  debris->step(deltaTime, constants.numObjects);
+  debris->writeObjects(constants.numObjects);
+  constants.numObjects += debris->getBodyCount();
+}
+
+void Renderer::trace(const FrameConstants &constants) {
+  glUseProgram(computeProgram);
+  pushFrameConstants(constants);
+  glBindImageTexture(0, outputTexture, 0, GL_FALSE, 0, GL_WRITE_ONLY,
+                     getOutputFormatInfo(outputFormat).internalFormat);
+
+  if (renderPath == RenderPath::Wavefront) {
+    wavefront->render();
+  } else {
+    glm::ivec2 origin(0);
+    glm::ivec2 size(width, height);
+    if (renderRegion.z > 0 && renderRegion.w > 0) {
+      origin = glm::ivec2(renderRegion.x, renderRegion.y);
+      size = glm::ivec2(renderRegion.z, renderRegion.w);
+    }
+    if (cameraLatch) {
+      // As late as possible: the GPU picks this up with the dispatch
+      CameraView view = cameraLatch();
+      LatchedCamera latched{glm::vec4(view.position, 0.0f),
+                            glm::vec4(glm::normalize(view.front), 0.0f),
+                            glm::vec4(glm::normalize(view.up), 0.0f)};
+      latchedCameraRing->push(&latched, LATCHED_CAMERA_BINDING);
+    }
+
+    glm::ivec2 tile = dispatchConfig.tileSize();
+    if (objectBinning) {
+      binner.configure(tile, static_cast<bool>(cameraLatch));
+      binner.bin(glm::ivec2(width, height), origin, size,
+                 constants.numObjects);
+      glUseProgram(computeProgram);
+      glm::ivec2 grid = binner.getGrid();
+      glUniform2i(binGridLoc, grid.x, grid.y);
+    }
+    if (adaptiveSamples > 0) {
+      // The refine pass traces like this one, minus binning and tiling
+      std::vector<std::string> refineDefines{
+          std::string("OUTPUT_IMAGE_FORMAT ") +
+          getOutputFormatInfo(outputFormat).imageQualifier};
+      if (cameraLatch) {
+        refineDefines.push_back("LATE_LATCH");
+      }
+      adaptiveSampler.configure(adaptiveSamples, refineDefines);
+      adaptiveSampler.begin(origin, size);
+      glUseProgram(computeProgram);
+      glUniform2i(regionSizeLoc, size.x, size.y);
+    }
+    glUniform2i(pixelOffsetLoc, origin.x, origin.y);
+    if (perfCountersEnabled) {
+      perfCounters.begin(glm::ivec2(width, height));
+    }
+
+    // Dispatch compute shader
+    glDispatchCompute((size.x + tile.x - 1) / tile.x,
+                      (size.y + tile.y - 1) / tile.y, 1);
+
+    if (adaptiveSamples > 0) {
+      adaptiveSampler.refine(outputTexture,
+                             getOutputFormatInfo(outputFormat).internalFormat,
+                             adaptiveThreshold);
+    }
+  }
+
+  // Make sure writing to image has finished before it is sampled or blitted
+  // (and the counter totals before the heatmap reads them)
+  glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT |
+                  GL_TEXTURE_FETCH_BARRIER_BIT | GL_FRAMEBUFFER_BARRIER_BIT |
+                  (perfCountersEnabled ? GL_SHADER_STORAGE_BARRIER_BIT : 0));
+}
+
+void Renderer::readPixels(const glm::ivec4 &region,
+                          std::vector<uint8_t> &rgba) {
+  rgba.resize(static_cast<size_t>(region.z) * region.w * 4);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  glPixelStorei(GL_PACK_ALIGNMENT, 4);
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, outputFramebuffer);
+  glReadPixels(region.x, region.y, region.z, region.w, GL_RGBA,
+               GL_UNSIGNED_BYTE, rgba.data());
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+}
+
+void Renderer::ensureViewArray(int count) {
+  if (count <= viewCapacity) {
+    return;
+  }
+  const OutputFormatInfo &info = getOutputFormatInfo(outputFormat);
+
+  MemoryTracker &memory = MemoryTracker::get();
+  memory.releaseTexture(viewArrayTexture);
+  glDeleteTextures(1, &viewArrayTexture);
+  glGenTextures(1, &viewArrayTexture);
+  glBindTexture(GL_TEXTURE_2D_ARRAY, viewArrayTexture);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, info.internalFormat, width, height,
+               count, 0, info.pixelFormat, info.pixelType, NULL);
+  memory.trackTexture(viewArrayTexture,
+                      static_cast<size_t>(width) * height * count *
+                          info.bytesPerPixel,
+                      MemoryCategory::OutputImage);
+
+  if (viewBuffer == 0) {
+    glGenBuffers(1, &viewBuffer);
+  }
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, viewBuffer);
+  glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(glm::vec4) * 3 * count,
+               nullptr, GL_DYNAMIC_DRAW);
+  memory.trackBuffer(viewBuffer, sizeof(glm::vec4) * 3 * count,
+                     MemoryCategory::SceneBuffers);
+
+  if (viewFramebuffer == 0) {
+    glGenFramebuffers(1, &viewFramebuffer);
+  }
+  viewCapacity = count;
+}
+
+void Renderer::renderViews(const std::vector<CameraView> &views) {
+  if (views.empty()) {
+    return;
+  }
+  uploadObjects();
+  FrameConstants constants = buildFrameConstants();
+  simulateDebris(lastDeltaTime, constants);
+  traceViews(views, constants);
+}
+
+void Renderer::renderViews(const FrameSnapshot &snapshot,
+                           const std::vector<CameraView> &views) {
+  if (views.empty()) {
+    return;
+  }
+  updateWater(snapshot);
+  uploadObjects(snapshot.objects);
+  FrameConstants constants = snapshot.constants;
+  simulateDebris(snapshot.water.deltaTime, constants);
+  traceViews(views, constants);
+}
+
+void Renderer::traceViews(const std::vector<CameraView> &views,
+                          const FrameConstants &constants) {
+  if (multiViewProgram == 0) {
+    multiViewProgram = buildComputeProgram({"MULTI_VIEW"});
+    glUseProgram(multiViewProgram);
+    glUniform1i(glGetUniformLocation(multiViewProgram, "paintingTexture"), 1);
+  }
+  viewCount = static_cast<int>(views.size());
+  ensureViewArray(viewCount);
+
+  // vec4-padded to match the std430 ViewCamera layout
+  std::vector<glm::vec4> viewData;
+  viewData.reserve(views.size() * 3);
+  for (const auto &view : views) {
+    viewData.push_back(glm::vec4(view.position, 0.0f));
+    viewData.push_back(glm::vec4(glm::normalize(view.front), 0.0f));
+    viewData.push_back(glm::vec4(glm::normalize(view.up), 0.0f));
+  }
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, viewBuffer);
+  glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0,
+                  viewData.size() * sizeof(glm::vec4), viewData.data());
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, viewBuffer);
+
+  glUseProgram(multiViewProgram);
+  pushFrameConstants(constants);
+  glBindImageTexture(0, viewArrayTexture, 0, GL_TRUE, 0, GL_WRITE_ONLY,
+                     getOutputFormatInfo(outputFormat).internalFormat);
+
+  // The z dimension selects the view
+  glm::ivec2 tile = dispatchConfig.tileSize();
+  glDispatchCompute((width + tile.x - 1) / tile.x,
+                    (height + tile.y - 1) / tile.y, viewCount);
+
+  glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT |
+                  GL_TEXTURE_FETCH_BARRIER_BIT | GL_FRAMEBUFFER_BARRIER_BIT);
+}
+
+void Renderer::blitViewToScreen(int view, int screenWidth, int screenHeight) {
+  if (view < 0 || view >= viewCount) {
+    return;
+  }
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, viewFramebuffer);
+  glFramebufferTextureLayer(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                            viewArrayTexture, 0, view);
+  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+  GLenum filter = (screenWidth == width && screenHeight == height)
+                      ? GL_NEAREST
+                      : GL_LINEAR;
+  glBlitFramebuffer(0, 0, width, height, 0, 0, screenWidth, screenHeight,
+                    GL_COLOR_BUFFER_BIT, filter);
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
 }
 
 void Renderer::adjustRustLevel(float delta) {
@@ -135,6 +611,7 @@ GLuint Renderer::compileComputeShader(const std::string &source) {
   if (!success) {
     GLchar infoLog[512];
     glGetShaderInfoLog(shader, 512, NULL, infoLog);
+    glDeleteShader(shader);
     throw std::runtime_error("Shader compilation failed: " +
                              std::string(infoLog));
   }
@@ -143,27 +620,90 @@ GLuint Renderer::compileComputeShader(const std::string &source) {
 }
 
 void Renderer::createShaders() {
-  std::string computePath = "shaders/raytracer.comp";
+  installComputeProgram(buildComputeProgram(getSingleViewDefines()));
+}
+
+void Renderer::installComputeProgram(GLuint program) {
+  glDeleteProgram(computeProgram);
+  computeProgram = program;
+  // Looked up once per program, the dispatch only sets the values
+  pixelOffsetLoc = glGetUniformLocation(computeProgram, "pixelOffset");
+  binGridLoc = glGetUniformLocation(computeProgram, "binGrid");
+  regionSizeLoc = glGetUniformLocation(computeProgram, "regionSize");
+}
+
+std::vector<std::string> Renderer::getSingleViewDefines() const {
+  std::vector<std::string> defines;
+  if (cameraLatch) {
+    defines.push_back("LATE_LATCH");
+  }
+  if (objectBinning) {
+    for (const auto &define : ObjectBinner::getTracerDefines()) {
+      defines.push_back(define);
+    }
+  }
+  if (adaptiveSamples > 0) {
+    for (const auto &define : AdaptiveSampler::getTracerDefines()) {
+      defines.push_back(define);
+    }
+  }
+  if (perfCountersEnabled) {
+    for (const auto &define : PerfCounters::getTracerDefines()) {
+      defines.push_back(define);
+    }
+  }
+  return defines;
+}
+
+std::string Renderer::getTracerVariant() const {
+  std::string variant = getOutputFormatInfo(outputFormat).imageQualifier;
+  for (const auto &define : getSingleViewDefines()) {
+    variant += " " + define;
+  }
+  return variant;
+}
+
+GLuint Renderer::buildComputeProgram(const std::vector<std::string> &defines) {
+  std::vector<std::string> allDefines = defines;
+  allDefines.push_back(std::string("OUTPUT_IMAGE_FORMAT ") +
+                       getOutputFormatInfo(outputFormat).imageQualifier);
+  glm::ivec2 tile = dispatchConfig.tileSize();
+  allDefines.push_back("LOCAL_SIZE_X " +
+                       std::to_string(dispatchConfig.localSizeX));
+  allDefines.push_back("LOCAL_SIZE_Y " +
+                       std::to_string(dispatchConfig.localSizeY));
+  allDefines.push_back("TILE_WIDTH " + std::to_string(tile.x));
+  allDefines.push_back("TILE_HEIGHT " + std::to_string(tile.y));
+  if (dispatchConfig.mortonOrder) {
+    allDefines.push_back("PIXEL_ORDER_MORTON");
+  }
+  return createComputeProgram("shaders/raytracer.comp", allDefines);
+}
+
+GLuint Renderer::createComputeProgram(const std::string &computePath,
+                                      const std::vector<std::string> &defines) {
   std::string computeSource = loadShaderSource(computePath);
   std::string preprocessedSource =
       preprocessShader(computeSource, getShaderDirectory(computePath));
+  preprocessedSource = addShaderDefines(preprocessedSource, defines);
 
   GLuint computeShader = compileComputeShader(preprocessedSource);
 
-  computeProgram = glCreateProgram();
-  glAttachShader(computeProgram, computeShader);
-  glLinkProgram(computeProgram);
+  GLuint program = glCreateProgram();
+  glAttachShader(program, computeShader);
+  glLinkProgram(program);
 
   GLint success;
-  glGetProgramiv(computeProgram, GL_LINK_STATUS, &success);
+  glGetProgramiv(program, GL_LINK_STATUS, &success);
   if (!success) {
     GLchar infoLog[512];
-    glGetProgramInfoLog(computeProgram, 512, NULL, infoLog);
+    glGetProgramInfoLog(program, 512, NULL, infoLog);
     throw std::runtime_error("Shader program linking failed: " +
                              std::string(infoLog));
   }
 
   glDeleteShader(computeShader);
+  return program;
 }
 
 std::string Renderer::getShaderDirectory(const std::string &shaderPath) {
@@ -174,6 +714,26 @@ std::string Renderer::getShaderDirectory(const std::string &shaderPath) {
   return "";
 }
 
+std::string Renderer::addShaderDefines(const std::string &source,
+                                       const std::vector<std::string> &defines) {
+  // Defines must follow the #version directive
+  size_t insertPos = 0;
+  size_t versionPos = source.find("#version");
+  if (versionPos != std::string::npos) {
+    size_t lineEnd = source.find('\n', versionPos);
+    insertPos = lineEnd == std::string::npos ? source.size() : lineEnd + 1;
+  }
+
+  std::string defineBlock;
+  for (const auto &define : defines) {
+    defineBlock += "#define " + define + "\n";
+  }
+
+  std::string result = source;
+  result.insert(insertPos, defineBlock);
+  return result;
+}
+
 std::string Renderer::preprocessShader(const std::string &source,
                                        const std::string &shaderDir) {
   std::string result = source;
@@ -212,6 +772,58 @@ std::string Renderer::preprocessShader(const std::string &source,
 }
 
 void Renderer::loadPaintingTexture(const std::string &path) {
+  // A cooked container next to the image skips decode and mip generation
+  MappedTextureContainer cooked;
+  if (isCookedTextureStale(path)) {
+    std::cerr << "Warning: " << path
+              << " is newer than its cooked container, decoding it instead"
+              << std::endl;
+    decodePaintingTexture(path);
+  } else if (cooked.open(getCookedTexturePath(path))) {
+    uploadCookedTexture(cooked);
+  } else {
+    decodePaintingTexture(path);
+  }
+
+  // Get uniform location and bind to texture unit 1
+  paintingTextureLoc = glGetUniformLocation(computeProgram, "paintingTexture");
+  glActiveTexture(GL_TEXTURE1);
+  glBindTexture(GL_TEXTURE_2D, paintingTexture);
+  glUniform1i(paintingTextureLoc, 1);
+}
+
+void Renderer::uploadCookedTexture(const MappedTextureContainer &container) {
+  const TextureContainerHeader &header = container.getHeader();
+  glGenTextures(1, &paintingTexture);
+  glBindTexture(GL_TEXTURE_2D, paintingTexture);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                  GL_LINEAR_MIPMAP_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL,
+                  static_cast<GLint>(header.levelCount) - 1);
+
+  glTexStorage2D(GL_TEXTURE_2D, static_cast<GLsizei>(header.levelCount),
+                 header.internalFormat, static_cast<GLsizei>(header.width),
+                 static_cast<GLsizei>(header.height));
+  // Levels are tightly packed; the driver copies straight out of the mapping
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  size_t bytes = 0;
+  for (uint32_t level = 0; level < header.levelCount; level++) {
+    const TextureContainerLevel &info = container.getLevel(level);
+    glTexSubImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), 0, 0,
+                    static_cast<GLsizei>(info.width),
+                    static_cast<GLsizei>(info.height), header.format,
+                    header.type, container.getLevelData(level));
+    bytes += info.size;
+  }
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  MemoryTracker::get().trackTexture(paintingTexture, bytes,
+                                    MemoryCategory::Textures);
+}
+
+void Renderer::decodePaintingTexture(const std::string &path) {
   int width, height, channels;
   stbi_set_flip_vertically_on_load(true);
   unsigned char *data = stbi_load(path.c_str(), &width, &height, &channels, 0);
@@ -232,14 +844,12 @@ void Renderer::loadPaintingTexture(const std::string &path) {
   glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format,
                GL_UNSIGNED_BYTE, data);
   glGenerateMipmap(GL_TEXTURE_2D);
+  // Drivers pad RGB to four bytes; the mip chain adds a third
+  MemoryTracker::get().trackTexture(
+      paintingTexture, static_cast<size_t>(width) * height * 4 * 4 / 3,
+      MemoryCategory::Textures);
 
   stbi_image_free(data);
-
-  // Get uniform location and bind to texture unit 1
-  paintingTextureLoc = glGetUniformLocation(computeProgram, "paintingTexture");
-  glActiveTexture(GL_TEXTURE1);
-  glBindTexture(GL_TEXTURE_2D, paintingTexture);
-  glUniform1i(paintingTextureLoc, 1);
 }
 
 void Renderer::adjustAge(float delta) {
@@ -260,14 +870,51 @@ void Renderer::setupDramaticScene() {
   setLightDirection(glm::vec3(-1.0f, -1.0f, -1.0f));
 }
 
+void Renderer::update(float deltaTime) {
+  currentTime += deltaTime;
+  lastDeltaTime = deltaTime;
+
+  // New water trails from physics become splashes on the water surface
+  for (size_t i = 0; i < scene.getObjects().size(); i++) {
+    for (auto &trail : scene.getObject(i).waterTrails) {
+      if (trail.time == 0.0f) {
+        pendingWaterImpacts.push_back({glm::vec2(trail.position.x, trail.position.z),
+                                       0.3f + trail.intensity * 0.5f,
+                                       trail.intensity * 0.2f});
+      }
+      trail.time += deltaTime;
+    }
+  }
+
+  // Trails only seed splashes, old ones are dropped so they cannot pile up
+  size_t trailCount = 0;
+  for (size_t i = 0; i < scene.getObjects().size(); i++) {
+    auto &trails = scene.getObject(i).waterTrails;
+    trails.erase(std::remove_if(trails.begin(), trails.end(),
+                                [](const WaterTrail &trail) {
+                                  return trail.time >
+                                         SceneObject::WATER_TRAIL_LIFETIME;
+                                }),
+                 trails.end());
+    trailCount += trails.capacity();
+  }
+
+  MemoryTracker &memory = MemoryTracker::get();
+  memory.setCpuUsage(MemoryCategory::SceneObjects, scene.getMemoryUsage());
+  memory.setCpuUsage(MemoryCategory::WaterTrails,
+                     trailCount * sizeof(WaterTrail));
+  memory.setCpuUsage(MemoryCategory::Physics, physics.getMemoryUsage());
+}
+
 void Renderer::updateWeather(float deltaTime) {
-  static float weatherCycle = 0.0f;
   weatherCycle += deltaTime * 0.1f; // Speed of weather changes
 
   // Create more dramatic moisture changes
   float newMoisture =
       (sin(weatherCycle) * 0.8f + 0.2f); // Range from 0.2 to 1.0
   setMoisture(newMoisture);
+  // Rain sets in once the air is wet enough
+  rainIntensity = glm::clamp((moisture - 0.4f) / 0.6f, 0.0f, 1.0f);
 
   // Dramatic light changes based on weather
   float baseIntensity = 2.0f;
@@ -3,24 +3,132 @@
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
 #include <string>
+#include "core/adaptive_sampler.hpp"
 #include "core/camera.hpp"
+#include "core/frame_constants.hpp"
+#include "core/frame_snapshot.hpp"
+#include "core/gpu_physics.hpp"
+#include "core/gpu_object.hpp"
+#include "core/object_binner.hpp"
+#include "core/perf_counters.hpp"
 #include "core/physics.hpp"
 #include "core/scene.hpp"
+#include "core/texture_container.hpp"
+#include "core/uniform_ring.hpp"
+#include "core/water_simulation.hpp"
+#include "core/wavefront_pipeline.hpp"
 #include "image_loader.hpp"
+#include <functional>
+#include <memory>
 #include <vector>
 
+// Storage format of the compute shader's output image. The tracer tonemaps
+// to LDR, so the narrower formats lose nothing visible and cut bandwidth.
+enum class OutputFormat {
+    RGBA32F,    // 16 bytes per pixel
+    RGBA8,      // 4 bytes per pixel
+    RGB10_A2,   // 4 bytes per pixel, 10 bits per colour channel
+    R11G11B10F  // 4 bytes per pixel, packed float, no alpha
+};
+
+// One camera of a batched multi-view render
+struct CameraView {
+    glm::vec3 position;
+    glm::vec3 front;
+    glm::vec3 up;
+};
+
+// Compute workgroup shape and the order its invocations walk pixels in
+struct DispatchConfig {
+    int localSizeX{8};
+    int localSizeY{8};
+    bool mortonOrder{false}; // Z-order walk of a square-ish tile
+
+    // Pixels covered by one workgroup
+    glm::ivec2 tileSize() const;
+    std::string toString() const;
+    static bool parse(const std::string& text, DispatchConfig& config);
+};
+
+// How render() turns the scene into the output image
+enum class RenderPath {
+    Megakernel, // one raytracer.comp invocation per pixel does everything
+    Wavefront   // staged queues with one shading kernel per material
+};
+
 class Renderer {
 public:
-    Renderer(int width, int height);
+    // The output format is baked into the tracer variants and fixed for the
+    // lifetime of the renderer
+    Renderer(int width, int height, OutputFormat format = OutputFormat::RGBA8);
     ~Renderer();
 
     void init();
     void render();
+    // Renders from a snapshot only, leaving live simulation state alone so
+    // it can be advanced on another thread meanwhile
+    void render(const FrameSnapshot& snapshot);
+    // Copies the state render() would use into `snapshot` and hands over
+    // the water forcing gathered since the previous snapshot
+    void captureSnapshot(FrameSnapshot& snapshot);
+    // Steps the water with the snapshot's forcing and stores the result in
+    // it, so renderers that skip frames can still show the water
+    void stepWater(FrameSnapshot& snapshot);
     void resize(int width, int height);
+    // Copies the output image straight into the default framebuffer,
+    // skipping the fullscreen quad pass.
+    void blitToScreen(int screenWidth, int screenHeight);
+    // Renders every view into its own layer of a 2D array texture with a
+    // single dispatch; objects and scene parameters are uploaded once.
+    void renderViews(const std::vector<CameraView>& views);
+    void renderViews(const FrameSnapshot& snapshot, const std::vector<CameraView>& views);
+    void blitViewToScreen(int view, int screenWidth, int screenHeight);
+    GLuint getViewArrayTexture() const { return viewArrayTexture; }
+    int getViewCount() const { return viewCount; }
     GLuint getOutputTexture() const { return outputTexture; }
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    OutputFormat getOutputFormat() const { return outputFormat; }
+    const DispatchConfig& getDispatchConfig() const { return dispatchConfig; }
+    // Defines and output format of the single-view tracer as currently
+    // built, one space separated line; a dispatch config is tuned for it
+    std::string getTracerVariant() const;
+    void setDispatchConfig(const DispatchConfig& config);
+    RenderPath getRenderPath() const { return renderPath; }
+    void setRenderPath(RenderPath path);
+    // Limits megakernel renders to x, y, width, height of the output image;
+    // a zero size renders all of it
+    void setRenderRegion(const glm::ivec4& region) { renderRegion = region; }
+    // Called right before each single-view megakernel dispatch; the camera
+    // it returns replaces the frame's own. Empty turns late latching off.
+    using CameraLatch = std::function<CameraView()>;
+    void setCameraLatch(CameraLatch latch);
+    // Screen-space tile binning before the megakernel trace (on by default)
+    void setObjectBinning(bool enabled);
+    bool getObjectBinning() const { return objectBinning; }
+    // Extra jittered rays for each pixel on an object edge or a luminance
+    // step above `contrastThreshold`; 0 traces one ray per pixel only.
+    // Applies to the single-view megakernel.
+    void setAdaptiveSampling(int extraSamples, float contrastThreshold = 0.1f);
+    int getAdaptiveSamples() const { return adaptiveSamples; }
+    // Switches the single-view megakernel to its instrumented variant,
+    // which records per-pixel work in getPerfCounters()
+    void setPerfCounters(bool enabled);
+    bool getPerfCountersEnabled() const { return perfCountersEnabled; }
+    const PerfCounters& getPerfCounters() const { return perfCounters; }
+    // Adds `count` debris spheres simulated by GpuPhysics, traced after the
+    // scene's objects; 0 removes them
+    void setDebris(int count, float radius = 0.08f);
+    int getDebrisCount() const { return debris ? debris->getBodyCount() : 0; }
+    // Reads a region of the output image back as RGBA8, rows bottom-up
+    void readPixels(const glm::ivec4& region, std::vector<uint8_t>& rgba);
+    static bool parseOutputFormat(const std::string& name, OutputFormat& format);
     static std::string loadShaderSource(const std::string& path);
     static std::string preprocessShader(const std::string& source, const std::string& shaderDir);
     static std::string getShaderDirectory(const std::string& shaderPath);
+    static std::string addShaderDefines(const std::string& source, const std::vector<std::string>& defines);
+    // Loads, preprocesses and links a compute shader file with extra defines
+    static GLuint createComputeProgram(const std::string& path, const std::vector<std::string>& defines);
     void setRustLevel(float level) {
         rustLevel = glm::clamp(level, 0.0f, 1.0f);
     }
@@ -35,6 +143,10 @@ public:
         frameWidth = glm::clamp(width, 0.01f, 0.5f);
     }
     float getFrameWidth() const { return frameWidth; }
+    // Scales the ray cone footprint that picks procedural material detail;
+    // 0 always evaluates every octave
+    void setLodScale(float scale) { lodScale = glm::max(scale, 0.0f); }
+    float getLodScale() const { return lodScale; }
     Physics& getPhysics() { return physics; }
     void setCameraPosition(const glm::vec3& pos) { camera.setPosition(pos); }
     Camera& getCamera() { return camera; }
@@ -46,9 +158,7 @@ public:
     void adjustMoisture(float delta) {
         moisture = glm::clamp(moisture + delta, 0.0f, 1.0f);
     }
-    void update(float deltaTime) {
-        currentTime += deltaTime;
-    }
+    void update(float deltaTime);
     void setLightDirection(const glm::vec3& dir) {
         lightDirection = glm::normalize(dir);
     }
@@ -61,43 +171,87 @@ public:
 
 private:
     int width, height;
-    GLuint computeProgram;
+    GLuint computeProgram{0};
+    GLint pixelOffsetLoc{-1};
+    GLint binGridLoc{-1};    // -1 without OBJECT_BINNING
+    GLint regionSizeLoc{-1}; // -1 without ADAPTIVE_SAMPLING
     GLuint outputTexture;
+    OutputFormat outputFormat;
+    DispatchConfig dispatchConfig;
+    GLuint outputFramebuffer{0};
+    std::unique_ptr<UniformRing> frameConstantsRing;
+    std::unique_ptr<UniformRing> latchedCameraRing;
+    CameraLatch cameraLatch;
+    bool objectBinning{true};
+    ObjectBinner binner;
+    int adaptiveSamples{0};
+    float adaptiveThreshold{0.1f};
+    AdaptiveSampler adaptiveSampler;
+    bool perfCountersEnabled{false};
+    PerfCounters perfCounters;
+    RenderPath renderPath{RenderPath::Megakernel};
+    glm::ivec4 renderRegion{0};
+    std::unique_ptr<WavefrontPipeline> wavefront;
+    GLuint multiViewProgram{0};
+    GLuint viewArrayTexture{0};
+    GLuint viewFramebuffer{0};
+    GLuint viewBuffer{0};
+    int viewCount{0};
+    int viewCapacity{0};
     float rustLevel{0.0f}; // 0.0 = no rust, 1.0 = full rust
-    GLint rustLevelLoc{-1};
-    GLuint paintingTexture;
+    GLuint paintingTexture{0};
     GLint paintingTextureLoc;
     float age{0.0f};
-    GLint ageLoc{-1};
-    GLint frameWidthLoc{-1};
     float frameWidth{0.1f};
+    float lodScale{1.0f};
     Physics physics;
     Camera camera;
-    GLint cameraPositionLoc{-1};
-    GLint cameraFrontLoc{-1};
-    GLint cameraUpLoc{-1};
     Scene scene;
     std::vector<GLint> objectPositionLocs;
-    GLint numObjectsLoc{-1};
     GLuint objectBuffer;
-    std::vector<glm::vec4> objectData;
+    size_t objectCapacity{0};
     float moisture{0.0f};
-    GLint moistureLoc{-1};
     EnvironmentParams environment;
     float currentTime{0.0f};
-    GLint iTimeLoc{-1};
+    float weatherCycle{0.0f};
     glm::vec3 lightDirection{-1.0f, -1.0f, -1.0f};
     float lightIntensity{1.0f};
-    GLint lightDirLoc{-1};
-    GLint lightIntensityLoc{-1};
     GLuint trailBuffer;
     GLint numTrailsLoc{-1};
     std::vector<WaterTrail> waterTrails;
+    std::unique_ptr<WaterSimulation> water;
+    std::unique_ptr<GpuPhysics> debris;
+    std::vector<WaterImpact> pendingWaterImpacts;
+    float rainIntensity{0.0f};
+    float lastDeltaTime{0.0f};
     void updateEnvironment(float deltaTime);
     void createShaders();
+    // Replaces the single-view tracer and caches its uniform locations
+    void installComputeProgram(GLuint program);
+    GLuint buildComputeProgram(const std::vector<std::string>& defines);
+    std::vector<std::string> getSingleViewDefines() const;
+    FrameConstants buildFrameConstants() const;
+    void pushFrameConstants(const FrameConstants& constants);
+    // Grows the object buffer to `count` scene records plus the debris
+    void reserveObjectBuffer(size_t count);
+    GpuObject* mapObjectBuffer(size_t count);
+    void uploadObjects();
+    void uploadObjects(const std::vector<GpuObject>& records);
+    // Folds finished debris impact readbacks into the water forcing
+    void stepWater(const WaterForcing& forcing);
+    // Loads the snapshot's water state if it has one, steps it otherwise
+    void updateWater(const FrameSnapshot& snapshot);
+    // Steps the debris and writes it after the uploaded scene objects
+    void simulateDebris(float deltaTime, FrameConstants& constants);
+    void trace(const FrameConstants& constants);
+    void traceViews(const std::vector<CameraView>& views, const FrameConstants& constants);
     void createOutputTexture();
-    GLuint compileComputeShader(const std::string& source);
+    void ensureViewArray(int count);
+    static GLuint compileComputeShader(const std::string& source);
+    // Prefers a cooked .gtex beside `path` over decoding the image
     void loadPaintingTexture(const std::string& path);
+    void uploadCookedTexture(const MappedTextureContainer& container);
+    void decodePaintingTexture(const std::string& path);
 
 
 };
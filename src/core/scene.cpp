@@ -1,6 +1,7 @@
 #include "scene.hpp"
 #include "physics.hpp"
-#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <cmath>
 
 Scene::Scene(Physics& physics) : physics(physics) {
     // Add ground as a default object
@@ -10,29 +11,65 @@ Scene::Scene(Physics& physics) : physics(physics) {
 }
 
 void Scene::update(float deltaTime) {
+    simulationTime += deltaTime;
+
     // Create environment parameters based on time of day
     EnvironmentParams env;
-    env.timeOfDay = static_cast<float>(fmod(glfwGetTime(), 24.0));
+    env.timeOfDay = static_cast<float>(std::fmod(simulationTime, 24.0));
     env.humidity = 0.5f;
     env.temperature = 20.0f;
     env.salinity = 0.1f;
 
-    for (auto& obj : objects) {
-        // Update aging for all objects
-        obj.updateAging(env, deltaTime);
+    for (size_t i = 0; i < objects.size(); i++) {
+        SceneObject& obj = objects[i];
+        obj.pendingAgingTime += deltaTime;
+        // Staggered by index so slow-aging objects spread across frames
+        if ((updateCount + i) % std::max(obj.agingInterval, 1) == 0) {
+            obj.updateAging(env, obj.pendingAgingTime);
+            obj.pendingAgingTime = 0.0f;
+        }
     }
+    updateCount++;
 }
 
 size_t Scene::addObject(ObjectType type, const glm::vec3& position, bool isDynamic) {
     objects.emplace_back(type, position);
     objects.back().isDynamic = isDynamic;
+    physics.invalidateBodies();
     return objects.size() - 1;
 }
 
+size_t Scene::addObject(const SceneObject& object) {
+    objects.push_back(object);
+    physics.invalidateBodies();
+    return objects.size() - 1;
+}
+
+std::vector<SceneObject> Scene::takeObjects(const std::function<bool(const SceneObject&)>& predicate) {
+    std::vector<SceneObject> taken;
+    auto kept = std::stable_partition(objects.begin(), objects.end(),
+                                      [&](const SceneObject& obj) { return !predicate(obj); });
+    if (kept != objects.end()) {
+        taken.assign(std::make_move_iterator(kept), std::make_move_iterator(objects.end()));
+        objects.erase(kept, objects.end());
+        physics.invalidateBodies();
+    }
+    return taken;
+}
+
 void Scene::removeObject(size_t id) {
     if (id < objects.size()) {
         objects.erase(objects.begin() + id);
+        physics.invalidateBodies();
+    }
+}
+
+size_t Scene::getMemoryUsage() const {
+    size_t bytes = objects.capacity() * sizeof(SceneObject);
+    for (const auto& obj : objects) {
+        bytes += obj.agingProps.stressPoints.capacity() * sizeof(glm::vec3);
     }
+    return bytes;
 }
 
 const SceneObject& Scene::getObject(size_t id) const {
@@ -1,5 +1,7 @@
 #pragma once
 #include "core/scene_object.hpp"
+#include <cstdint>
+#include <functional>
 #include <vector>
 #include <memory>
 #include <glm/glm.hpp>
@@ -10,12 +12,21 @@ public:
 
     void update(float deltaTime);
     size_t addObject(ObjectType type, const glm::vec3& position, bool isDynamic = false);
+    size_t addObject(const SceneObject& object);
     void removeObject(size_t id);
+    // Removes every object matching `predicate` and returns them
+    std::vector<SceneObject> takeObjects(const std::function<bool(const SceneObject&)>& predicate);
     const SceneObject& getObject(size_t id) const;
     SceneObject& getObject(size_t id);
     const std::vector<SceneObject>& getObjects() const { return objects; }
+    // Heap bytes of the object records and their aging stress points;
+    // water trails are left to the caller
+    size_t getMemoryUsage() const;
 
 private:
     std::vector<SceneObject> objects;
     Physics& physics;
+    // Accumulated simulation time, so aging only depends on the frame deltas
+    double simulationTime{0.0};
+    uint64_t updateCount{0};
 };
@@ -1,5 +1,7 @@
 #pragma once
 #include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 
 enum class ObjectType {
@@ -31,17 +33,36 @@ struct SceneObject {
     glm::vec3 rotation{0.0f};
     float rustLevel{0.0f};
     bool isDynamic{false};
+    // Resting bodies are skipped by the physics step until something wakes them
+    bool sleeping{false};
+    float sleepTimer{0.0f}; // seconds spent below the sleep speed
+    uint32_t sleepIsland{0}; // bodies it fell asleep with share this, 0 when awake
+    // Loaded from a streaming cell and saved back when it unloads
+    bool streamed{false};
+    // Aging runs every agingInterval scene updates with the time gathered
+    // since, so distant objects cost less while aging at the same pace
+    int agingInterval{1};
+    float pendingAgingTime{0.0f};
     std::vector<WaterTrail> waterTrails;
     float lastTrailTime{0.0f};
     struct AgingProperties {
-        float exposure;
-        float resistance;
-        float currentAge;
+        // Not used by updateAging; only carried through the streaming cell format
+        float exposure{1.0f};
+        float resistance{0.0f};
+        float currentAge{0.0f};
         std::vector<glm::vec3> stressPoints;
     } agingProps;
 
     void updateAging(const EnvironmentParams& env, float deltaTime);
+    // Trails older than this are dropped by Renderer::update, and an object
+    // never keeps more than MAX_WATER_TRAILS (the oldest go first)
+    static constexpr float WATER_TRAIL_LIFETIME = 2.0f;
+    static constexpr size_t MAX_WATER_TRAILS = 16;
+
     void addWaterTrail(const glm::vec3& pos, float intensity) {
+        if (waterTrails.size() >= MAX_WATER_TRAILS) {
+            waterTrails.erase(waterTrails.begin());
+        }
         waterTrails.push_back({pos, intensity, 0.0f});
     }
     SceneObject(ObjectType t, const glm::vec3& pos)
@@ -0,0 +1,265 @@
+#include "scene_streamer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+namespace {
+
+const char* const OBJECT_TYPE_NAMES[] = {"sphere", "rectangle", "ground", "wall"};
+
+bool parseObjectType(const std::string& name, ObjectType& type) {
+    for (int i = 0; i < 4; i++) {
+        if (name == OBJECT_TYPE_NAMES[i]) {
+            type = static_cast<ObjectType>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+void writeVec3(std::ostream& out, const glm::vec3& v) {
+    out << " " << v.x << " " << v.y << " " << v.z;
+}
+
+// `out` is a cell's own text; floats are written so they read back exactly
+void writeObject(std::ostream& out, const SceneObject& obj) {
+    out << std::setprecision(std::numeric_limits<float>::max_digits10);
+    out << OBJECT_TYPE_NAMES[static_cast<int>(obj.type)] << " " << (obj.isDynamic ? 1 : 0);
+    writeVec3(out, obj.position);
+    writeVec3(out, obj.velocity);
+    writeVec3(out, obj.scale);
+    writeVec3(out, obj.rotation);
+    out << " " << obj.rustLevel << " " << obj.agingProps.currentAge << " " << obj.agingProps.exposure << " "
+        << obj.agingProps.resistance << "\n";
+}
+
+bool readObject(const std::string& line, SceneObject& obj) {
+    std::istringstream in(line);
+    std::string typeName;
+    int dynamic = 0;
+    in >> typeName >> dynamic;
+    if (!parseObjectType(typeName, obj.type)) {
+        return false;
+    }
+    obj.isDynamic = dynamic != 0;
+    in >> obj.position.x >> obj.position.y >> obj.position.z
+       >> obj.velocity.x >> obj.velocity.y >> obj.velocity.z
+       >> obj.scale.x >> obj.scale.y >> obj.scale.z
+       >> obj.rotation.x >> obj.rotation.y >> obj.rotation.z
+       >> obj.rustLevel >> obj.agingProps.currentAge >> obj.agingProps.exposure >> obj.agingProps.resistance;
+    return !in.fail();
+}
+
+} // namespace
+
+bool readSceneFile(const std::string& path, std::vector<SceneObject>& objects) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        if (line.empty() || line[0] == '#') continue;
+        SceneObject obj(ObjectType::SPHERE, glm::vec3(0.0f));
+        if (readObject(line, obj)) {
+            objects.push_back(std::move(obj));
+        } else {
+            std::cerr << "Skipping malformed object at " << path << ":" << lineNumber << std::endl;
+        }
+    }
+    return true;
+}
+
+SceneStreamer::SceneStreamer(Scene& scene, StreamingSettings streamingSettings)
+    : scene(scene), settings(std::move(streamingSettings)) {
+    settings.cellSize = std::max(settings.cellSize, 0.1f);
+    settings.farAgingInterval = std::max(settings.farAgingInterval, 1);
+    loader = std::thread(&SceneStreamer::loaderLoop, this);
+}
+
+SceneStreamer::~SceneStreamer() {
+    std::vector<CellKey> loadedCells;
+    for (const auto& cell : cells) {
+        if (cell.second.loaded) {
+            loadedCells.push_back(cell.first);
+        }
+    }
+    std::vector<SceneObject> streamed;
+    for (const auto& obj : scene.getObjects()) {
+        if (obj.streamed) {
+            streamed.push_back(obj);
+        }
+    }
+    saveObjects(streamed, loadedCells);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    jobAvailable.notify_one();
+    loader.join();
+}
+
+void SceneStreamer::update(const glm::vec3& cameraPosition) {
+    applyLoadResults();
+
+    // Request every cell in range that is neither loaded nor loading
+    const CellKey center = getCell(cameraPosition);
+    const int reach = static_cast<int>(std::ceil(settings.loadRadius / settings.cellSize));
+    for (int x = center.first - reach; x <= center.first + reach; x++) {
+        for (int z = center.second - reach; z <= center.second + reach; z++) {
+            CellKey key(x, z);
+            if (cells.count(key) || getCellDistance(key, cameraPosition) > settings.loadRadius) {
+                continue;
+            }
+            Cell& cell = cells[key];
+            cell.ticket = nextTicket++;
+            Job job;
+            job.key = key;
+            job.ticket = cell.ticket;
+            queueJob(std::move(job));
+        }
+    }
+
+    // Drop cells past the hysteresis band; a cancelled load is just ignored
+    std::vector<CellKey> unloaded;
+    const float unloadRadius = settings.loadRadius + settings.unloadMargin;
+    for (auto it = cells.begin(); it != cells.end();) {
+        if (getCellDistance(it->first, cameraPosition) > unloadRadius) {
+            if (it->second.loaded) {
+                unloaded.push_back(it->first);
+            }
+            it = cells.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    // Streamed objects now outside every live cell go back to disk
+    std::vector<SceneObject> leaving = scene.takeObjects([&](const SceneObject& obj) {
+        return obj.streamed && cells.count(getCell(obj.position)) == 0;
+    });
+    if (!leaving.empty() || !unloaded.empty()) {
+        saveObjects(leaving, unloaded);
+    }
+
+    // Distant objects age in larger, less frequent steps
+    for (size_t i = 0; i < scene.getObjects().size(); i++) {
+        SceneObject& obj = scene.getObject(i);
+        if (obj.streamed) {
+            float distance = glm::length(glm::vec2(obj.position.x - cameraPosition.x,
+                                                   obj.position.z - cameraPosition.z));
+            obj.agingInterval = distance > settings.fullRateRadius ? settings.farAgingInterval : 1;
+        }
+    }
+}
+
+size_t SceneStreamer::getLoadedCellCount() const {
+    size_t count = 0;
+    for (const auto& cell : cells) {
+        if (cell.second.loaded) count++;
+    }
+    return count;
+}
+
+SceneStreamer::CellKey SceneStreamer::getCell(const glm::vec3& position) const {
+    return CellKey(static_cast<int>(std::floor(position.x / settings.cellSize)),
+                   static_cast<int>(std::floor(position.z / settings.cellSize)));
+}
+
+float SceneStreamer::getCellDistance(const CellKey& key, const glm::vec3& position) const {
+    glm::vec2 cellCenter((key.first + 0.5f) * settings.cellSize, (key.second + 0.5f) * settings.cellSize);
+    return glm::length(cellCenter - glm::vec2(position.x, position.z));
+}
+
+std::string SceneStreamer::getCellPath(const CellKey& key) const {
+    return settings.directory + "/cell_" + std::to_string(key.first) + "_" + std::to_string(key.second) + ".txt";
+}
+
+void SceneStreamer::applyLoadResults() {
+    std::vector<LoadResult> finished;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        finished.swap(results);
+    }
+    for (auto& result : finished) {
+        auto cell = cells.find(result.key);
+        if (cell == cells.end() || cell->second.ticket != result.ticket) {
+            continue; // unloaded or re-requested while loading
+        }
+        cell->second.loaded = true;
+        for (auto& obj : result.objects) {
+            obj.streamed = true;
+            scene.addObject(obj);
+        }
+    }
+}
+
+void SceneStreamer::saveObjects(const std::vector<SceneObject>& objects, const std::vector<CellKey>& replacedCells) {
+    std::map<CellKey, std::ostringstream> texts;
+    for (const auto& key : replacedCells) {
+        texts[key];
+    }
+    for (const auto& obj : objects) {
+        writeObject(texts[getCell(obj.position)], obj);
+    }
+    for (auto& text : texts) {
+        Job job;
+        job.key = text.first;
+        job.save = true;
+        job.append = std::find(replacedCells.begin(), replacedCells.end(), text.first) == replacedCells.end();
+        job.text = text.second.str();
+        queueJob(std::move(job));
+    }
+}
+
+void SceneStreamer::queueJob(Job job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back(std::move(job));
+    }
+    jobAvailable.notify_one();
+}
+
+void SceneStreamer::loaderLoop() {
+    // Jobs run in order, so a cell is always read after its last save
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        jobAvailable.wait(lock, [this] { return stopping || !jobs.empty(); });
+        if (jobs.empty()) {
+            return;
+        }
+        Job job = std::move(jobs.front());
+        jobs.pop_front();
+        if (!job.save && stopping) {
+            continue;
+        }
+        lock.unlock();
+
+        const std::string path = getCellPath(job.key);
+        if (job.save) {
+            std::ofstream file(path, job.append ? std::ios::app : std::ios::trunc);
+            file << job.text;
+            if (!file) {
+                std::cerr << "Failed to save scene cell " << path << std::endl;
+            }
+            lock.lock();
+        } else {
+            LoadResult result{job.key, job.ticket, readCell(path)};
+            lock.lock();
+            results.push_back(std::move(result));
+        }
+    }
+}
+
+std::vector<SceneObject> SceneStreamer::readCell(const std::string& path) const {
+    std::vector<SceneObject> objects;
+    readSceneFile(path, objects); // a missing file is an empty cell
+    return objects;
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include "core/scene.hpp"
+#include <glm/glm.hpp>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Appends the objects of a file in the cell format described below, one per
+// line; blank lines and lines starting with '#' are skipped. Returns false
+// when the file cannot be opened.
+bool readSceneFile(const std::string& path, std::vector<SceneObject>& objects);
+
+struct StreamingSettings {
+    std::string directory;      // holds cell_<x>_<z>.txt files
+    float cellSize{16.0f};      // cells are square in x/z
+    float loadRadius{32.0f};    // cells whose center is this close get loaded
+    float unloadMargin{16.0f};  // and unload only beyond loadRadius + margin
+    float fullRateRadius{24.0f};
+    int farAgingInterval{4};    // aging runs every n updates past fullRateRadius
+};
+
+// Streams scene objects in x/z grid cells around the camera. Cells are read
+// and written on a loader thread, so update() only queues requests and adds
+// or removes objects whose cell has finished loading. A streamed object is
+// saved with the cell its current position falls in when that cell is not
+// loaded, so moving and aging state survive unloading. Cell files hold one
+// object per line:
+//   type dynamic px py pz vx vy vz sx sy sz rx ry rz rust age exposure resistance
+// with type one of sphere, rectangle, ground or wall.
+class SceneStreamer {
+public:
+    SceneStreamer(Scene& scene, StreamingSettings settings);
+    // Saves every loaded cell before returning
+    ~SceneStreamer();
+
+    SceneStreamer(const SceneStreamer&) = delete;
+    SceneStreamer& operator=(const SceneStreamer&) = delete;
+
+    void update(const glm::vec3& cameraPosition);
+
+    size_t getLoadedCellCount() const;
+
+private:
+    using CellKey = std::pair<int, int>;
+
+    struct Cell {
+        bool loaded{false};     // false while its load is still queued
+        uint64_t ticket{0};     // matches the load result meant for it
+    };
+
+    struct Job {
+        CellKey key;
+        uint64_t ticket{0};
+        bool save{false};
+        bool append{false};     // add to the file instead of replacing it
+        std::string text;
+    };
+
+    struct LoadResult {
+        CellKey key;
+        uint64_t ticket;
+        std::vector<SceneObject> objects;
+    };
+
+    Scene& scene;
+    StreamingSettings settings;
+    std::map<CellKey, Cell> cells;
+    uint64_t nextTicket{1};
+
+    std::mutex mutex;
+    std::condition_variable jobAvailable;
+    std::deque<Job> jobs;
+    std::vector<LoadResult> results;
+    bool stopping{false};
+    std::thread loader;
+
+    CellKey getCell(const glm::vec3& position) const;
+    float getCellDistance(const CellKey& key, const glm::vec3& position) const;
+    std::string getCellPath(const CellKey& key) const;
+    void applyLoadResults();
+    // Writes each object to the cell its position falls in. Cells listed in
+    // `replacedCells` are rewritten, any other cell file is appended to.
+    void saveObjects(const std::vector<SceneObject>& objects, const std::vector<CellKey>& replacedCells);
+    void queueJob(Job job);
+    void loaderLoop();
+    std::vector<SceneObject> readCell(const std::string& path) const;
+};
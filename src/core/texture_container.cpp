@@ -0,0 +1,184 @@
+#include "texture_container.hpp"
+#include <glad/glad.h>
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+// Bytes per texel of the formats the cook writes, 0 for anything else
+size_t getTexelSize(const TextureContainerHeader& header) {
+    if (header.internalFormat == GL_RGBA8 && header.format == GL_RGBA && header.type == GL_UNSIGNED_BYTE) {
+        return 4;
+    }
+    return 0;
+}
+
+// Header and level table describe a complete mip chain whose levels all
+// lie inside the `size` bytes of the file
+bool isValidContainer(const uint8_t* data, size_t size) {
+    if (size < sizeof(TextureContainerHeader)) {
+        return false;
+    }
+    const auto* header = reinterpret_cast<const TextureContainerHeader*>(data);
+    if (std::memcmp(header->magic, "GTEX", 4) != 0 || header->version != TEXTURE_CONTAINER_VERSION ||
+        header->width == 0 || header->height == 0 || header->levelCount == 0) {
+        return false;
+    }
+    uint32_t maxLevels = 1;
+    for (uint32_t extent = std::max(header->width, header->height); extent > 1; extent /= 2) {
+        maxLevels++;
+    }
+    const size_t texelSize = getTexelSize(*header);
+    if (header->levelCount > maxLevels || texelSize == 0 ||
+        size < sizeof(TextureContainerHeader) + sizeof(TextureContainerLevel) * header->levelCount) {
+        return false;
+    }
+
+    const auto* levels = reinterpret_cast<const TextureContainerLevel*>(data + sizeof(TextureContainerHeader));
+    for (uint32_t i = 0; i < header->levelCount; i++) {
+        const TextureContainerLevel& level = levels[i];
+        if (level.width != std::max(header->width >> i, 1u) || level.height != std::max(header->height >> i, 1u) ||
+            level.size != static_cast<uint64_t>(level.width) * level.height * texelSize ||
+            level.offset > size || level.size > size - level.offset) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+void writeTextureContainer(const std::string& path, uint32_t internalFormat, uint32_t format, uint32_t type,
+                           const std::vector<TextureLevelData>& levels) {
+    if (levels.empty()) {
+        throw std::runtime_error("Texture container needs at least one level: " + path);
+    }
+
+    TextureContainerHeader header{};
+    std::memcpy(header.magic, "GTEX", 4);
+    header.version = TEXTURE_CONTAINER_VERSION;
+    header.width = levels[0].width;
+    header.height = levels[0].height;
+    header.levelCount = static_cast<uint32_t>(levels.size());
+    header.internalFormat = internalFormat;
+    header.format = format;
+    header.type = type;
+
+    std::vector<TextureContainerLevel> table(levels.size());
+    size_t offset = alignUp(sizeof(header) + sizeof(TextureContainerLevel) * table.size(),
+                            TEXTURE_CONTAINER_LEVEL_ALIGNMENT);
+    for (size_t i = 0; i < levels.size(); i++) {
+        table[i] = {levels[i].width, levels[i].height, offset, levels[i].pixels.size()};
+        offset = alignUp(offset + levels[i].pixels.size(), TEXTURE_CONTAINER_LEVEL_ALIGNMENT);
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Failed to open texture container for writing: " + path);
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(table.data()), sizeof(TextureContainerLevel) * table.size());
+    const char padding[TEXTURE_CONTAINER_LEVEL_ALIGNMENT] = {};
+    for (size_t i = 0; i < levels.size(); i++) {
+        const size_t position = static_cast<size_t>(file.tellp());
+        file.write(padding, static_cast<std::streamsize>(table[i].offset - position));
+        file.write(reinterpret_cast<const char*>(levels[i].pixels.data()),
+                   static_cast<std::streamsize>(levels[i].pixels.size()));
+    }
+    if (!file) {
+        throw std::runtime_error("Failed to write texture container: " + path);
+    }
+}
+
+std::string getCookedTexturePath(const std::string& imagePath) {
+    const size_t dot = imagePath.find_last_of('.');
+    const size_t slash = imagePath.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return imagePath + ".gtex";
+    }
+    return imagePath.substr(0, dot) + ".gtex";
+}
+
+bool isCookedTextureStale(const std::string& imagePath) {
+    std::error_code error;
+    const auto imageTime = std::filesystem::last_write_time(imagePath, error);
+    if (error) {
+        return false; // only the container ships, nothing to compare
+    }
+    const auto cookedTime = std::filesystem::last_write_time(getCookedTexturePath(imagePath), error);
+    return !error && imageTime > cookedTime;
+}
+
+MappedTextureContainer::~MappedTextureContainer() {
+    close();
+}
+
+bool MappedTextureContainer::open(const std::string& path) {
+    close();
+#ifndef _WIN32
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        ::close(fd);
+        throw std::runtime_error("Empty or unreadable texture container: " + path);
+    }
+    void* mapped = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        throw std::runtime_error("Failed to map texture container: " + path);
+    }
+    // Every byte is about to be copied out front to back
+    madvise(mapped, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+    madvise(mapped, static_cast<size_t>(info.st_size), MADV_WILLNEED);
+    data = static_cast<const uint8_t*>(mapped);
+    size = static_cast<size_t>(info.st_size);
+#else
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        return false;
+    }
+    fallback.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(fallback.data()), static_cast<std::streamsize>(fallback.size()));
+    data = fallback.data();
+    size = fallback.size();
+#endif
+
+    if (!isValidContainer(data, size)) {
+        close();
+        throw std::runtime_error("Malformed texture container: " + path);
+    }
+    header = reinterpret_cast<const TextureContainerHeader*>(data);
+    levels = reinterpret_cast<const TextureContainerLevel*>(data + sizeof(TextureContainerHeader));
+    return true;
+}
+
+void MappedTextureContainer::close() {
+#ifndef _WIN32
+    if (data) {
+        munmap(const_cast<uint8_t*>(data), size);
+    }
+#endif
+    fallback.clear();
+    data = nullptr;
+    size = 0;
+    header = nullptr;
+    levels = nullptr;
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Cooked texture container (.gtex) written by tools/texture_cook. It holds a
+// full mip chain already in its final GL format, so loading is a file map
+// and one glTexSubImage2D per level. Little endian layout:
+//   TextureContainerHeader
+//   TextureContainerLevel[levelCount]
+//   level data, each level starting on a LEVEL_ALIGNMENT boundary
+// Rows are tightly packed and bottom-up, as GL expects them.
+struct TextureContainerHeader {
+    char magic[4];             // "GTEX"
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t levelCount;
+    uint32_t internalFormat;   // for glTexStorage2D
+    uint32_t format;           // pixel transfer format and type
+    uint32_t type;
+};
+
+struct TextureContainerLevel {
+    uint32_t width;
+    uint32_t height;
+    uint64_t offset;           // from the start of the file
+    uint64_t size;
+};
+
+const uint32_t TEXTURE_CONTAINER_VERSION = 1;
+const size_t TEXTURE_CONTAINER_LEVEL_ALIGNMENT = 16;
+
+// One level as handed to the writer
+struct TextureLevelData {
+    uint32_t width;
+    uint32_t height;
+    std::vector<uint8_t> pixels;
+};
+
+// Container path for an image: its extension, if any, replaced by .gtex
+std::string getCookedTexturePath(const std::string& imagePath);
+// True when the image was modified after its container was cooked
+bool isCookedTextureStale(const std::string& imagePath);
+
+// Writes `levels` (base level first) in the given GL format; throws on I/O errors
+void writeTextureContainer(const std::string& path, uint32_t internalFormat, uint32_t format, uint32_t type,
+                           const std::vector<TextureLevelData>& levels);
+
+// Read-only view of a container file. The file is memory mapped where the
+// platform allows it and read in one go elsewhere; level pointers stay
+// valid for the lifetime of the object.
+class MappedTextureContainer {
+public:
+    MappedTextureContainer() = default;
+    ~MappedTextureContainer();
+
+    MappedTextureContainer(const MappedTextureContainer&) = delete;
+    MappedTextureContainer& operator=(const MappedTextureContainer&) = delete;
+
+    // Returns false if the file does not exist, throws if it is malformed:
+    // levels must form a mip chain of RGBA8 data that fits in the file
+    bool open(const std::string& path);
+
+    const TextureContainerHeader& getHeader() const { return *header; }
+    const TextureContainerLevel& getLevel(uint32_t level) const { return levels[level]; }
+    const uint8_t* getLevelData(uint32_t level) const { return data + levels[level].offset; }
+    size_t getSize() const { return size; }
+
+private:
+    const uint8_t* data{nullptr};
+    size_t size{0};
+    const TextureContainerHeader* header{nullptr};
+    const TextureContainerLevel* levels{nullptr};
+    std::vector<uint8_t> fallback;   // file contents when not mapped
+
+    void close();
+};
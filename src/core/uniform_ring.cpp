@@ -0,0 +1,65 @@
+#include "uniform_ring.hpp"
+#include "memory_tracker.hpp"
+#include <cstring>
+#include <stdexcept>
+
+UniformRing::UniformRing(size_t size, int slotCount)
+    : blockSize(size), slots(slotCount > 0 ? slotCount : 1) {
+    GLint alignment = 256;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    slotStride = (blockSize + alignment - 1) / alignment * alignment;
+    const size_t totalSize = slotStride * slots.size();
+
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+    if (GLAD_GL_VERSION_4_4) {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_UNIFORM_BUFFER, totalSize, nullptr, flags);
+        mapped = static_cast<unsigned char*>(glMapBufferRange(GL_UNIFORM_BUFFER, 0, totalSize, flags));
+        if (!mapped) {
+            throw std::runtime_error("Failed to map uniform ring buffer");
+        }
+    } else {
+        glBufferData(GL_UNIFORM_BUFFER, totalSize, nullptr, GL_DYNAMIC_DRAW);
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    MemoryTracker::get().trackBuffer(buffer, totalSize, MemoryCategory::Uniforms);
+}
+
+UniformRing::~UniformRing() {
+    for (auto& slot : slots) {
+        if (slot.fence) glDeleteSync(slot.fence);
+    }
+    if (mapped) {
+        glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+        glUnmapBuffer(GL_UNIFORM_BUFFER);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+    MemoryTracker::get().releaseBuffer(buffer);
+    glDeleteBuffers(1, &buffer);
+}
+
+void UniformRing::push(const void* data, GLuint binding) {
+    // Everything submitted since the last push may read the current slot
+    if (currentSlot >= 0) {
+        slots[currentSlot].fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+    currentSlot = (currentSlot + 1) % static_cast<int>(slots.size());
+
+    Slot& slot = slots[currentSlot];
+    if (slot.fence) {
+        glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+    }
+
+    const size_t offset = slotStride * currentSlot;
+    if (mapped) {
+        std::memcpy(mapped + offset, data, blockSize);
+    } else {
+        glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+        glBufferSubData(GL_UNIFORM_BUFFER, offset, blockSize, data);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+    glBindBufferRange(GL_UNIFORM_BUFFER, binding, buffer, offset, blockSize);
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <glad/glad.h>
+#include <cstddef>
+#include <vector>
+
+// Ring of uniform block slots in one buffer. With GL 4.4 the buffer is
+// persistently mapped and each push is a single memcpy; older contexts fall
+// back to glBufferSubData. Every slot is fenced when the ring moves past it,
+// so a slot is only rewritten once the GPU has finished reading it.
+class UniformRing {
+public:
+    UniformRing(size_t blockSize, int slotCount = 3);
+    ~UniformRing();
+
+    UniformRing(const UniformRing&) = delete;
+    UniformRing& operator=(const UniformRing&) = delete;
+
+    // Copies `data` (blockSize bytes) into the next free slot and binds it
+    // to the given uniform block binding point
+    void push(const void* data, GLuint binding);
+
+private:
+    struct Slot {
+        GLsync fence{nullptr};
+    };
+
+    GLuint buffer{0};
+    size_t blockSize;
+    size_t slotStride;
+    std::vector<Slot> slots;
+    int currentSlot{-1};
+    unsigned char* mapped{nullptr};
+};
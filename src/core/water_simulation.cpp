@@ -0,0 +1,112 @@
+#include "water_simulation.hpp"
+#include "memory_tracker.hpp"
+#include "renderer.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+const float WAVE_SPEED = 0.4f;     // metres per second
+const float WAVE_DAMPING = 0.985f; // per step
+
+} // namespace
+
+WaterSimulation::WaterSimulation() {
+    program = Renderer::createComputeProgram("shaders/water/wave_step.comp", {});
+    waveCoefficientLoc = glGetUniformLocation(program, "waveCoefficient");
+    dampingLoc = glGetUniformLocation(program, "damping");
+    timeStepLoc = glGetUniformLocation(program, "timeStep");
+    rainIntensityLoc = glGetUniformLocation(program, "rainIntensity");
+    stepIndexLoc = glGetUniformLocation(program, "stepIndex");
+    impactCountLoc = glGetUniformLocation(program, "impactCount");
+    impactsLoc = glGetUniformLocation(program, "impacts");
+
+    // Still, dry water everywhere
+    const std::vector<float> zeros(RESOLUTION * RESOLUTION * 4, 0.0f);
+    const float border[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    glGenTextures(2, stateTextures);
+    for (GLuint texture : stateTextures) {
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+        glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, border);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, RESOLUTION, RESOLUTION, 0, GL_RGBA, GL_FLOAT, zeros.data());
+        MemoryTracker::get().trackTexture(texture, RESOLUTION * RESOLUTION * 8, MemoryCategory::Water);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+WaterSimulation::~WaterSimulation() {
+    glDeleteProgram(program);
+    for (GLuint texture : stateTextures) {
+        MemoryTracker::get().releaseTexture(texture);
+    }
+    glDeleteTextures(2, stateTextures);
+}
+
+void WaterSimulation::step(const WaterForcing& forcing) {
+    // Splashes only enter on the first step of the frame
+    std::vector<glm::vec4> impacts;
+    const float toTexels = RESOLUTION / EXTENT;
+    for (const auto& impact : forcing.impacts) {
+        if (impacts.size() == static_cast<size_t>(MAX_IMPACTS)) break;
+        glm::vec2 texel = (impact.position / EXTENT + 0.5f) * static_cast<float>(RESOLUTION);
+        impacts.push_back(glm::vec4(texel, std::max(impact.radius * toTexels, 1.0f), impact.strength));
+    }
+
+    // Fixed steps keep the wave equation stable whatever the frame time
+    accumulator = std::min(accumulator + forcing.deltaTime, TIMESTEP * MAX_STEPS_PER_FRAME);
+    while (accumulator >= TIMESTEP) {
+        dispatchStep(forcing.rainIntensity, impacts);
+        impacts.clear();
+        accumulator -= TIMESTEP;
+    }
+}
+
+void WaterSimulation::dispatchStep(float rainIntensity, const std::vector<glm::vec4>& impacts) {
+    const float texelSize = EXTENT / RESOLUTION;
+    const float courant = WAVE_SPEED * TIMESTEP / texelSize;
+
+    glUseProgram(program);
+    glUniform1f(waveCoefficientLoc, courant * courant);
+    glUniform1f(dampingLoc, WAVE_DAMPING);
+    glUniform1f(timeStepLoc, TIMESTEP);
+    glUniform1f(rainIntensityLoc, rainIntensity);
+    glUniform1ui(stepIndexLoc, stepIndex++);
+    glUniform1i(impactCountLoc, static_cast<GLint>(impacts.size()));
+    if (!impacts.empty()) {
+        glUniform4fv(impactsLoc, static_cast<GLsizei>(impacts.size()), &impacts[0].x);
+    }
+
+    const int next = 1 - current;
+    glBindImageTexture(1, stateTextures[current], 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA16F);
+    glBindImageTexture(2, stateTextures[next], 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+    glDispatchCompute((RESOLUTION + 7) / 8, (RESOLUTION + 7) / 8, 1);
+    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+    current = next;
+}
+
+void WaterSimulation::bindState() const {
+    glActiveTexture(GL_TEXTURE0 + TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_2D, stateTextures[current]);
+}
+
+void WaterSimulation::readState(std::vector<uint8_t>& state) const {
+    state.resize(STATE_SIZE);
+    glBindTexture(GL_TEXTURE_2D, stateTextures[current]);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_HALF_FLOAT, state.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void WaterSimulation::loadState(const std::vector<uint8_t>& state) {
+    if (state.size() != STATE_SIZE) {
+        throw std::runtime_error("Water state has the wrong size");
+    }
+    glBindTexture(GL_TEXTURE_2D, stateTextures[current]);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, RESOLUTION, RESOLUTION, GL_RGBA, GL_HALF_FLOAT, state.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
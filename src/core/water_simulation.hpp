@@ -0,0 +1,67 @@
+#pragma once
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+// A splash on the water surface, in world XZ
+struct WaterImpact {
+    glm::vec2 position;
+    float radius;
+    float strength;
+};
+
+// What drives the water during one frame
+struct WaterForcing {
+    float deltaTime{0.0f};
+    float rainIntensity{0.0f}; // 0 = dry, 1 = downpour
+    std::vector<WaterImpact> impacts;
+};
+
+// Height-field wave simulation over the ground, stepped on the GPU at a
+// fixed resolution and timestep. State lives in two RGBA16F textures used
+// ping-pong: height, previous height, wetness. Ground shading samples the
+// current one through the `waterState` sampler, so the cost does not depend
+// on the screen resolution.
+class WaterSimulation {
+public:
+    static const int RESOLUTION = 256;
+    static constexpr float EXTENT = 16.0f; // world units covered, centred on the origin
+    static constexpr float TIMESTEP = 1.0f / 60.0f;
+    static const int MAX_IMPACTS = 16;     // matches MAX_WATER_IMPACTS in wave_step.comp
+    static const GLuint TEXTURE_UNIT = 2;  // matches the waterState sampler binding
+    static const size_t STATE_SIZE = RESOLUTION * RESOLUTION * 8; // bytes of RGBA16F state
+
+    WaterSimulation();
+    ~WaterSimulation();
+
+    WaterSimulation(const WaterSimulation&) = delete;
+    WaterSimulation& operator=(const WaterSimulation&) = delete;
+
+    void step(const WaterForcing& forcing);
+    // Binds the current state to TEXTURE_UNIT for shading
+    void bindState() const;
+    // Copy of the current state, STATE_SIZE bytes, to hand to another renderer
+    void readState(std::vector<uint8_t>& state) const;
+    // Replaces the current state with one from readState
+    void loadState(const std::vector<uint8_t>& state);
+
+private:
+    static const int MAX_STEPS_PER_FRAME = 4;
+
+    GLuint program{0};
+    GLuint stateTextures[2]{};
+    int current{0};
+    float accumulator{0.0f};
+    GLuint stepIndex{0};
+
+    GLint waveCoefficientLoc{-1};
+    GLint dampingLoc{-1};
+    GLint timeStepLoc{-1};
+    GLint rainIntensityLoc{-1};
+    GLint stepIndexLoc{-1};
+    GLint impactCountLoc{-1};
+    GLint impactsLoc{-1};
+
+    void dispatchStep(float rainIntensity, const std::vector<glm::vec4>& impacts);
+};
@@ -0,0 +1,125 @@
+#include "wavefront_pipeline.hpp"
+#include "memory_tracker.hpp"
+#include "renderer.hpp"
+
+namespace {
+
+// Sizes of the std430 records in shaders/wavefront/queues.glsl
+const size_t RAY_RECORD_SIZE = 32;
+const size_t HIT_RECORD_SIZE = 16;
+// rayCount, hitCount, then counts, offsets and cursors per material
+const size_t COUNTER_BUFFER_SIZE = sizeof(GLuint) * (2 + 3 * WavefrontPipeline::MATERIAL_COUNT);
+const size_t DISPATCH_ARGS_SIZE = sizeof(GLuint) * 4;
+
+// Indices into the indirect argument buffer
+const int DISPATCH_INTERSECT = 0;
+const int DISPATCH_SORT = 1;
+const int DISPATCH_SHADE = 2;
+
+// Shader storage binding points
+const GLuint RAY_QUEUE_BINDING = 3;
+const GLuint HIT_QUEUE_BINDING = 4;
+const GLuint SORTED_HIT_QUEUE_BINDING = 5;
+const GLuint COUNTER_BINDING = 6;
+const GLuint DISPATCH_ARGS_BINDING = 7;
+
+GLuint createStorageBuffer(size_t size) {
+    GLuint buffer;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, size, nullptr, GL_DYNAMIC_COPY);
+    MemoryTracker::get().trackBuffer(buffer, size, MemoryCategory::Wavefront);
+    return buffer;
+}
+
+} // namespace
+
+WavefrontPipeline::WavefrontPipeline(int w, int h, const std::string& outputImageFormat)
+    : width(w), height(h) {
+    raygenProgram = Renderer::createComputeProgram("shaders/wavefront/raygen.comp", {});
+    prepareIntersectProgram = Renderer::createComputeProgram("shaders/wavefront/prepare.comp", {});
+    prepareShadeProgram = Renderer::createComputeProgram("shaders/wavefront/prepare.comp", {"PREPARE_SHADE"});
+    intersectProgram = Renderer::createComputeProgram("shaders/wavefront/intersect.comp", {});
+    sortProgram = Renderer::createComputeProgram("shaders/wavefront/sort.comp", {});
+    for (int m = 0; m < MATERIAL_COUNT; m++) {
+        shadePrograms[m] = Renderer::createComputeProgram(
+            "shaders/wavefront/shade.comp",
+            {"SHADE_MATERIAL " + std::to_string(m), "OUTPUT_IMAGE_FORMAT " + outputImageFormat});
+    }
+    imageResolutionLoc = glGetUniformLocation(raygenProgram, "imageResolution");
+
+    const size_t rayCapacity = static_cast<size_t>(width) * height;
+    rayBuffer = createStorageBuffer(rayCapacity * RAY_RECORD_SIZE);
+    hitBuffer = createStorageBuffer(rayCapacity * HIT_RECORD_SIZE);
+    sortedHitBuffer = createStorageBuffer(rayCapacity * HIT_RECORD_SIZE);
+    counterBuffer = createStorageBuffer(COUNTER_BUFFER_SIZE);
+    dispatchBuffer = createStorageBuffer(DISPATCH_ARGS_SIZE * (DISPATCH_SHADE + MATERIAL_COUNT));
+}
+
+WavefrontPipeline::~WavefrontPipeline() {
+    glDeleteProgram(raygenProgram);
+    glDeleteProgram(prepareIntersectProgram);
+    glDeleteProgram(prepareShadeProgram);
+    glDeleteProgram(intersectProgram);
+    glDeleteProgram(sortProgram);
+    for (GLuint program : shadePrograms) {
+        glDeleteProgram(program);
+    }
+    for (GLuint buffer : {rayBuffer, hitBuffer, sortedHitBuffer, counterBuffer, dispatchBuffer}) {
+        MemoryTracker::get().releaseBuffer(buffer);
+    }
+    glDeleteBuffers(1, &rayBuffer);
+    glDeleteBuffers(1, &hitBuffer);
+    glDeleteBuffers(1, &sortedHitBuffer);
+    glDeleteBuffers(1, &counterBuffer);
+    glDeleteBuffers(1, &dispatchBuffer);
+}
+
+void WavefrontPipeline::bindBuffers() {
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, RAY_QUEUE_BINDING, rayBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, HIT_QUEUE_BINDING, hitBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SORTED_HIT_QUEUE_BINDING, sortedHitBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, COUNTER_BINDING, counterBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, DISPATCH_ARGS_BINDING, dispatchBuffer);
+    glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, dispatchBuffer);
+}
+
+void WavefrontPipeline::render() {
+    bindBuffers();
+
+    // Reset the queue counters
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, counterBuffer);
+    glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    const GLbitfield queueBarrier = GL_SHADER_STORAGE_BARRIER_BIT;
+    const GLbitfield argsBarrier = GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT;
+
+    glUseProgram(raygenProgram);
+    glUniform2i(imageResolutionLoc, width, height);
+    glDispatchCompute((width + 7) / 8, (height + 7) / 8, 1);
+    glMemoryBarrier(queueBarrier);
+
+    glUseProgram(prepareIntersectProgram);
+    glDispatchCompute(1, 1, 1);
+    glMemoryBarrier(argsBarrier);
+
+    glUseProgram(intersectProgram);
+    glDispatchComputeIndirect(DISPATCH_ARGS_SIZE * DISPATCH_INTERSECT);
+    glMemoryBarrier(queueBarrier);
+
+    glUseProgram(prepareShadeProgram);
+    glDispatchCompute(1, 1, 1);
+    glMemoryBarrier(argsBarrier);
+
+    glUseProgram(sortProgram);
+    glDispatchComputeIndirect(DISPATCH_ARGS_SIZE * DISPATCH_SORT);
+    glMemoryBarrier(queueBarrier);
+
+    for (int m = 0; m < MATERIAL_COUNT; m++) {
+        glUseProgram(shadePrograms[m]);
+        glDispatchComputeIndirect(DISPATCH_ARGS_SIZE * (DISPATCH_SHADE + m));
+    }
+
+    glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, 0);
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <glad/glad.h>
+#include <string>
+
+// Staged alternative to the raytracer.comp megakernel:
+//   raygen -> intersect -> sort by material -> one shading kernel per material
+// Every stage after ray generation is sized with glDispatchComputeIndirect
+// from counters the previous stage produced. Expects the object buffer,
+// frame constants, painting texture and output image to be bound already.
+class WavefrontPipeline {
+public:
+    static const int MATERIAL_COUNT = 6; // sky, steel, wood, paint, brick, ground
+
+    WavefrontPipeline(int width, int height, const std::string& outputImageFormat);
+    ~WavefrontPipeline();
+
+    WavefrontPipeline(const WavefrontPipeline&) = delete;
+    WavefrontPipeline& operator=(const WavefrontPipeline&) = delete;
+
+    void render();
+
+private:
+    int width, height;
+
+    GLuint raygenProgram{0};
+    GLuint prepareIntersectProgram{0};
+    GLuint intersectProgram{0};
+    GLuint prepareShadeProgram{0};
+    GLuint sortProgram{0};
+    GLuint shadePrograms[MATERIAL_COUNT]{};
+    GLint imageResolutionLoc{-1};
+
+    GLuint rayBuffer{0};
+    GLuint hitBuffer{0};
+    GLuint sortedHitBuffer{0};
+    GLuint counterBuffer{0};
+    GLuint dispatchBuffer{0};
+
+    void bindBuffers();
+};
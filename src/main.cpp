@@ -1,5 +1,24 @@
 #include "core/renderer.hpp"
+#include "core/dispatch_autotuner.hpp"
+#include "core/frame_capture.hpp"
+#include "core/frame_pipeline.hpp"
+#include "core/input_recorder.hpp"
+#include "core/latency_tracker.hpp"
+#include "core/memory_tracker.hpp"
+#include "core/render_cluster.hpp"
+#include "core/render_server.hpp"
+#include "core/scene_streamer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <fstream>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <type_traits>
 #include <vector>
 
 const int WINDOW_WIDTH = 1024;
@@ -8,14 +27,110 @@ const float RUST_CHANGE_SPEED = 0.5f;
 float lastX = WINDOW_WIDTH / 2.0f;
 float lastY = WINDOW_HEIGHT / 2.0f;
 bool firstMouse = true;
-
+// Mouse movement accumulated by the cursor callback until the next frame
+float pendingMouseX = 0.0f;
+float pendingMouseY = 0.0f;
+
+enum class PresentMode {
+    Quad,   // sample the output texture through a fullscreen quad
+    Blit    // glBlitFramebuffer straight into the default framebuffer
+};
+
+struct AppOptions {
+    OutputFormat outputFormat = OutputFormat::RGBA8;
+    PresentMode presentMode = PresentMode::Blit;
+    bool capture = false;
+    CaptureSettings captureSettings;
+    uint64_t captureFrameLimit = 0; // 0 = capture until the window closes
+    int viewCount = 0;              // > 0 renders an orbit of views per frame
+    std::string recordPath;         // log input and timesteps to this file
+    std::string replayPath;         // feed a recording back instead of live input
+    float fixedDeltaTime = 0.0f;    // > 0 overrides the measured frame time
+    bool unthrottled = false;       // disable vsync, run as fast as possible
+    std::string frameTracePath;     // per-frame CPU timings as CSV
+    bool autotune = true;           // search for the fastest dispatch config
+    std::string autotuneCachePath = "autotune_cache.txt";
+    bool forceDispatch = false;
+    DispatchConfig dispatchConfig;
+    RenderPath renderPath = RenderPath::Megakernel;
+    float lodScale = 1.0f;          // material detail falloff, 0 = full detail
+    int framesInFlight = 1;         // > 1 simulates ahead on a second thread
+    float physicsStep = 0.0f;       // > 0 overrides the fixed physics timestep
+    int workerCount = 0;            // > 0 renders offline across worker processes
+    int tilesPerFrame = 4;          // bands each distributed frame is split into
+    bool latency = false;           // report input-to-photon latency on exit
+    std::string latencyTracePath;   // per-frame latency as CSV
+    bool lateLatch = false;         // re-sample the view right before dispatch
+    StreamingSettings streaming;    // directory set = stream cells around the camera
+    bool objectBinning = true;      // tile-bin objects before the megakernel trace
+    int adaptiveSamples = 0;        // extra rays per edge pixel, 0 = 1 spp only
+    float adaptiveThreshold = 0.1f; // luminance step that marks a pixel for refinement
+    int debrisCount = 0;            // spheres simulated by the GPU physics pass
+    std::string serveEndpoint;      // Unix socket path or "-" for stdin: run as a render server
+    float memoryReportInterval = 0.0f; // > 0 logs tracked memory every n seconds
+    int perfView = 0;               // quad.frag debugView: 0 = render, 1-4 = cost heatmaps
+    float perfReportInterval = 0.0f; // > 0 logs shader work counters every n seconds
+    size_t gpuBudget = 0;           // bytes, 0 = no budget
+    size_t cpuBudget = 0;
+};
+
+// Input handed to the frame pipeline but not rendered yet
+struct SubmittedInput {
+    double sampleTime;
+    float mouseDeltaX;
+    float mouseDeltaY;
+};
+
+bool parseOptions(int argc, char** argv, AppOptions& options);
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
-void processInput(GLFWwindow* window, Renderer& renderer, float deltaTime);
-GLuint createQuadProgram();
-GLuint createQuadVAO();
+InputFrame sampleInput(GLFWwindow* window);
+void processInput(const InputFrame& input, Renderer& renderer);
+void configureRenderer(Renderer& renderer, const AppOptions& options);
+void prepareRenderer(Renderer& renderer, const AppOptions& options);
+void simulateFrame(const InputFrame& input, Renderer& renderer, SceneStreamer* streamer, FrameSnapshot& snapshot);
+int runDistributed(const AppOptions& options, int workerSocket, std::vector<RenderWorkerProcess> workers);
+int runServer(const AppOptions& options);
+std::vector<CameraView> makeOrbitViews(int count);
+GLuint createQuadProgram(const std::vector<std::string>& defines);
+GLuint createQuadVAO(GLuint& vbo);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 
-int main() {
+int main(int argc, char** argv) {
+    AppOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        return -1;
+    }
+    if (options.lateLatch && options.framesInFlight < 2) {
+        // Only frames simulated ahead leave input for the latch to apply
+        std::cerr << "--late-latch needs --frames-in-flight 2 or more" << std::endl;
+        return -1;
+    }
+
+    // Workers are forked before GLFW starts so each one gets its own context
+    std::vector<RenderWorkerProcess> workers;
+    int workerSocket = -1;
+    if (options.workerCount > 0) {
+        if (!options.capture || options.captureFrameLimit == 0 ||
+            options.captureSettings.format != CaptureFormat::PNG) {
+            std::cerr << "--workers needs --capture <prefix> and --capture-frames <n> with PNG output" << std::endl;
+            return -1;
+        }
+        if (options.debrisCount > 0) {
+            // Workers render frames out of order, GPU-resident state cannot follow
+            std::cerr << "--debris cannot be combined with --workers" << std::endl;
+            return -1;
+        }
+        try {
+            workerSocket = spawnRenderWorkers(options.workerCount, workers);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return -1;
+        }
+    }
+
+    MemoryTracker::get().setGpuBudget(options.gpuBudget);
+    MemoryTracker::get().setCpuBudget(options.cpuBudget);
+
     if (!glfwInit()) {
         std::cerr << "Failed to initialize GLFW" << std::endl;
         return -1;
@@ -24,6 +139,10 @@ int main() {
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    if (options.workerCount > 0 || !options.serveEndpoint.empty()) {
+        // Offline rendering is headless, the window only carries the context
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    }
 
     GLFWwindow* window = glfwCreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "Compute Shader Raytracer", NULL, NULL);
     if (!window) {
@@ -40,54 +159,284 @@ int main() {
         return -1;
     }
 
+    if (options.workerCount > 0) {
+        int status = runDistributed(options, workerSocket, std::move(workers));
+        glfwTerminate();
+        return status;
+    }
+    if (!options.serveEndpoint.empty()) {
+        int status = runServer(options);
+        glfwTerminate();
+        return status;
+    }
+
     try {
-        Renderer renderer(WINDOW_WIDTH, WINDOW_HEIGHT);
-        renderer.setupDramaticScene();
+        Renderer renderer(WINDOW_WIDTH, WINDOW_HEIGHT, options.outputFormat);
+        configureRenderer(renderer, options);
+        if (options.lateLatch && options.replayPath.empty()) {
+            // Tune the latched tracer variant; the real latch is installed
+            // once the loop state it reads exists
+            renderer.setCameraLatch([&renderer]() {
+                const Camera& camera = renderer.getCamera();
+                return CameraView{camera.getPosition(), camera.getFront(), glm::vec3(0.0f, 1.0f, 0.0f)};
+            });
+        }
+        prepareRenderer(renderer, options);
         glfwSetWindowUserPointer(window, &renderer);
         glfwSetCursorPosCallback(window, mouse_callback);
         glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
 
         // Create and setup quad for displaying the texture
-        GLuint quadVAO = createQuadVAO();
-        GLuint quadProgram = createQuadProgram();
+        GLuint quadVAO = 0;
+        GLuint quadVBO = 0;
+        GLuint quadProgram = 0;
+        if (options.presentMode == PresentMode::Quad) {
+            quadVAO = createQuadVAO(quadVBO);
+            std::vector<std::string> quadDefines;
+            if (options.perfView > 0) {
+                // The heatmap scales by the frame maxima in the totals block
+                GLint fragmentBlocks = 0;
+                glGetIntegerv(GL_MAX_FRAGMENT_SHADER_STORAGE_BLOCKS, &fragmentBlocks);
+                if (fragmentBlocks < 1) {
+                    throw std::runtime_error("--perf-view needs storage blocks in fragment shaders");
+                }
+                quadDefines.push_back("PERF_HEATMAP");
+            }
+            quadProgram = createQuadProgram(quadDefines);
+
+            // Set texture uniform
+            glUseProgram(quadProgram);
+            glUniform1i(glGetUniformLocation(quadProgram, "screenTexture"), 0);
+            if (options.perfView > 0) {
+                glUniform1i(glGetUniformLocation(quadProgram, "perfTexture"), 3);
+                glUniform1i(glGetUniformLocation(quadProgram, "debugView"), options.perfView);
+            }
+        }
+        std::unique_ptr<FrameCapture> frameCapture;
+        if (options.capture) {
+            frameCapture = std::make_unique<FrameCapture>(
+                renderer.getWidth(), renderer.getHeight(), options.captureSettings);
+        }
+
+        std::unique_ptr<InputRecorder> inputRecorder;
+        std::unique_ptr<InputPlayer> inputPlayer;
+        if (!options.recordPath.empty()) {
+            inputRecorder = std::make_unique<InputRecorder>(options.recordPath);
+        }
+        if (!options.replayPath.empty()) {
+            inputPlayer = std::make_unique<InputPlayer>(options.replayPath);
+        }
+        // Divergence can only be judged when the recorded timesteps are kept
+        bool verifyReplay = inputPlayer && options.fixedDeltaTime <= 0.0f;
+        uint64_t divergedFrames = 0;
+
+        std::unique_ptr<LatencyTracker> latency;
+        if (options.latency) {
+            latency = std::make_unique<LatencyTracker>(options.latencyTracePath);
+        }
 
-        // Set texture uniform
-        glUseProgram(quadProgram);
-        glUniform1i(glGetUniformLocation(quadProgram, "screenTexture"), 0);
+        std::ofstream frameTrace;
+        if (!options.frameTracePath.empty()) {
+            frameTrace.open(options.frameTracePath);
+            frameTrace << "frame,cpu_ms,delta_time\n";
+        }
+        if (options.unthrottled) {
+            glfwSwapInterval(0);
+        }
+
+        std::unique_ptr<SceneStreamer> streamer;
+        if (!options.streaming.directory.empty()) {
+            streamer = std::make_unique<SceneStreamer>(renderer.getScene(), options.streaming);
+        }
+
+        // Simulation step; runs on the pipeline's thread when frames overlap
+        FramePipeline pipeline(options.framesInFlight, [&](const InputFrame& input, FrameSnapshot& snapshot) {
+            simulateFrame(input, renderer, streamer.get(), snapshot);
+        });
+        FrameSnapshot snapshot;
+        std::deque<CameraRecord> expectedCameras;
+        std::deque<SubmittedInput> inFlightInputs;
+
+        if (options.lateLatch && !inputPlayer) {
+            // Turn the snapshot's view by the mouse movement of the frames
+            // sampled after it that the simulation has not caught up with.
+            // Events are only polled once per frame, so there is nothing
+            // newer to read at dispatch time.
+            renderer.setCameraLatch([&]() {
+                if (latency) {
+                    latency->markLatch(glfwGetTime());
+                }
+                float mouseX = 0.0f;
+                float mouseY = 0.0f;
+                for (const auto& input : inFlightInputs) {
+                    mouseX += input.mouseDeltaX;
+                    mouseY += input.mouseDeltaY;
+                }
+                glm::vec3 front = renderer.getCamera().turnedFront(snapshot.constants.cameraFront, mouseX, mouseY);
+                return CameraView{snapshot.constants.cameraPosition, front, glm::vec3(0.0f, 1.0f, 0.0f)};
+            });
+        }
+
+        double lastMemoryReport = glfwGetTime();
+        double lastPerfReport = lastMemoryReport;
         float lastFrame = 0.0f;
         // Main rendering loop
         while (!glfwWindowShouldClose(window)) {
-            float currentFrame = glfwGetTime();
+            double frameStart = glfwGetTime();
+            float currentFrame = static_cast<float>(frameStart);
             float deltaTime = currentFrame - lastFrame;
             lastFrame = currentFrame;
-            renderer.getPhysics().update(deltaTime);
-            renderer.getScene().update(deltaTime);
-            renderer.updateWeather(deltaTime);
-            renderer.update(deltaTime);
-            processInput(window, renderer, deltaTime);
+
+            InputFrame input;
+            const double sampleTime = glfwGetTime();
+            if (inputPlayer) {
+                CameraRecord expectedCamera;
+                if (!inputPlayer->next(input, expectedCamera)) {
+                    break;
+                }
+                expectedCameras.push_back(expectedCamera);
+                sampleInput(window); // still honour Escape, discard live input
+            } else {
+                input = sampleInput(window);
+                input.deltaTime = deltaTime;
+            }
+            if (options.fixedDeltaTime > 0.0f) {
+                input.deltaTime = options.fixedDeltaTime;
+            }
+
+            pipeline.submit(input);
+            inFlightInputs.push_back({sampleTime, input.mouseDeltaX, input.mouseDeltaY});
+            if (!pipeline.acquire(snapshot)) {
+                // Pipeline still filling, nothing to render yet
+                glfwPollEvents();
+                continue;
+            }
+            const uint64_t frameIndex = snapshot.frameIndex;
+            if (latency) {
+                latency->beginFrame(frameIndex, inFlightInputs.front().sampleTime);
+            }
+            inFlightInputs.pop_front();
+
+            CameraRecord camera{snapshot.constants.cameraPosition, snapshot.constants.cameraFront};
+            if (inputRecorder) {
+                inputRecorder->record(snapshot.input, camera);
+            }
+            if (inputPlayer) {
+                CameraRecord expectedCamera = expectedCameras.front();
+                expectedCameras.pop_front();
+                if (verifyReplay &&
+                    (camera.position != expectedCamera.position || camera.front != expectedCamera.front)) {
+                    if (divergedFrames++ == 0) {
+                        std::cerr << "Replay diverged from the recording at frame " << frameIndex << std::endl;
+                    }
+                }
+            }
 
             // Render the scene using compute shader
-            renderer.render();
+            if (options.viewCount > 0) {
+                renderer.renderViews(snapshot, makeOrbitViews(options.viewCount));
+            } else {
+                renderer.render(snapshot);
+            }
+            if (latency) {
+                latency->markSubmit(glfwGetTime());
+            }
+
+            if (frameCapture) {
+                if (options.viewCount > 0) {
+                    for (int view = 0; view < renderer.getViewCount(); view++) {
+                        frameCapture->capture(renderer.getViewArrayTexture(), view);
+                    }
+                } else {
+                    frameCapture->capture(renderer.getOutputTexture());
+                }
+                if (options.captureFrameLimit > 0 &&
+                    frameCapture->getCapturedFrames() + frameCapture->getDroppedFrames() >=
+                        options.captureFrameLimit) {
+                    glfwSetWindowShouldClose(window, true);
+                }
+            }
 
             // Display the rendered texture
-            glClear(GL_COLOR_BUFFER_BIT);
+            if (options.viewCount > 0) {
+                // Multi-view output lives in an array texture, show the first view
+                int screenWidth, screenHeight;
+                glfwGetFramebufferSize(window, &screenWidth, &screenHeight);
+                renderer.blitViewToScreen(0, screenWidth, screenHeight);
+            } else if (options.presentMode == PresentMode::Blit) {
+                int screenWidth, screenHeight;
+                glfwGetFramebufferSize(window, &screenWidth, &screenHeight);
+                renderer.blitToScreen(screenWidth, screenHeight);
+            } else {
+                glClear(GL_COLOR_BUFFER_BIT);
+
+                glUseProgram(quadProgram);
+                glBindVertexArray(quadVAO);
+
+                glActiveTexture(GL_TEXTURE0);
+                glBindTexture(GL_TEXTURE_2D, renderer.getOutputTexture());
+                if (options.perfView > 0) {
+                    glActiveTexture(GL_TEXTURE3);
+                    glBindTexture(GL_TEXTURE_2D, renderer.getPerfCounters().getTexture());
+                    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, PerfCounters::TOTALS_BINDING,
+                                     renderer.getPerfCounters().getTotalsBuffer());
+                    glActiveTexture(GL_TEXTURE0);
+                }
+
+                glDrawArrays(GL_TRIANGLES, 0, 6);
+            }
 
-            glUseProgram(quadProgram);
-            glBindVertexArray(quadVAO);
+            glfwSwapBuffers(window);
+            if (latency) {
+                latency->markSwap(glfwGetTime());
+            }
+            glfwPollEvents();
 
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, renderer.getOutputTexture());
+            if (frameTrace.is_open()) {
+                frameTrace << frameIndex << "," << (glfwGetTime() - frameStart) * 1000.0 << ","
+                           << snapshot.input.deltaTime << "\n";
+            }
+            if (options.memoryReportInterval > 0.0f &&
+                frameStart - lastMemoryReport >= options.memoryReportInterval) {
+                MemoryTracker::get().report(std::cout);
+                lastMemoryReport = frameStart;
+            }
+            if (options.perfReportInterval > 0.0f && frameStart - lastPerfReport >= options.perfReportInterval) {
+                renderer.getPerfCounters().readTotals().report(std::cout);
+                lastPerfReport = frameStart;
+            }
+        }
 
-            glDrawArrays(GL_TRIANGLES, 0, 6);
+        if (inputPlayer) {
+            std::cout << "Replayed " << inputPlayer->getFrameCount() << " frames";
+            if (verifyReplay) {
+                std::cout << ", " << divergedFrames << " diverged";
+            }
+            std::cout << std::endl;
+        }
 
-            glfwSwapBuffers(window);
-            glfwPollEvents();
+        if (latency) {
+            latency->report();
+            latency.reset();
+        }
+        if (options.memoryReportInterval > 0.0f) {
+            MemoryTracker::get().report(std::cout);
         }
 
         // Cleanup
-        glDeleteVertexArrays(1, &quadVAO);
-        glDeleteProgram(quadProgram);
+        if (frameCapture) {
+            frameCapture->finish();
+            std::cout << "Captured " << frameCapture->getCapturedFrames() << " frames, dropped "
+                      << frameCapture->getDroppedFrames() << std::endl;
+            frameCapture.reset();
+        }
+        if (options.presentMode == PresentMode::Quad) {
+            MemoryTracker::get().releaseBuffer(quadVBO);
+            glDeleteBuffers(1, &quadVBO);
+            glDeleteVertexArrays(1, &quadVAO);
+            glDeleteProgram(quadProgram);
+        }
     }
     catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
@@ -98,28 +447,359 @@ int main() {
     return 0;
 }
 
+void configureRenderer(Renderer& renderer, const AppOptions& options) {
+    renderer.setupDramaticScene();
+    renderer.setLodScale(options.lodScale);
+    if (options.physicsStep > 0.0f) {
+        renderer.getPhysics().setFixedTimestep(options.physicsStep);
+    }
+    renderer.setObjectBinning(options.objectBinning);
+    renderer.setAdaptiveSampling(options.adaptiveSamples, options.adaptiveThreshold);
+    renderer.setPerfCounters(options.perfView > 0 || options.perfReportInterval > 0.0f);
+    if (options.forceDispatch) {
+        renderer.setDispatchConfig(options.dispatchConfig);
+    }
+}
+
+// Debris, dispatch autotuning and the render path, for windowed and served
+// renders; distributed ones keep the defaults
+void prepareRenderer(Renderer& renderer, const AppOptions& options) {
+    renderer.setDebris(options.debrisCount);
+    if (!options.forceDispatch && options.autotune && options.renderPath == RenderPath::Megakernel) {
+        DispatchAutotuner(options.autotuneCachePath).tune(renderer);
+    }
+    renderer.setRenderPath(options.renderPath);
+}
+
+void simulateFrame(const InputFrame& input, Renderer& renderer, SceneStreamer* streamer, FrameSnapshot& snapshot) {
+    const float deltaTime = input.deltaTime;
+    renderer.getPhysics().update(deltaTime);
+    renderer.getScene().update(deltaTime);
+    renderer.updateWeather(deltaTime);
+    renderer.update(deltaTime);
+    processInput(input, renderer);
+    if (streamer) {
+        streamer->update(renderer.getCamera().getPosition());
+    }
+    renderer.captureSnapshot(snapshot);
+}
+
+// Headless render server. Like runDistributed, everything GL is destroyed
+// here so the caller can tear down the context afterwards.
+int runServer(const AppOptions& options) {
+    try {
+        Renderer renderer(WINDOW_WIDTH, WINDOW_HEIGHT, options.outputFormat);
+        configureRenderer(renderer, options);
+        prepareRenderer(renderer, options);
+        // stdout may carry the replies, so the summary goes to stderr
+        RenderServer server(renderer, options.serveEndpoint);
+        server.run();
+        std::cerr << "Served " << server.getCompletedJobs() << " jobs, " << server.getFailedJobs()
+                  << " failed" << std::endl;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return -1;
+    }
+    return 0;
+}
+
+// Coordinator or worker side of an offline render across processes. The
+// coordinator only simulates; workers render the tiles it hands out. Neither
+// autotunes, as concurrent timings on a shared GPU would mislead.
+int runDistributed(const AppOptions& options, int workerSocket, std::vector<RenderWorkerProcess> workers) {
+    try {
+        Renderer renderer(WINDOW_WIDTH, WINDOW_HEIGHT, options.outputFormat);
+        configureRenderer(renderer, options);
+        if (workerSocket >= 0) {
+            runRenderWorker(workerSocket, renderer);
+            return 0;
+        }
+
+        RenderClusterSettings settings;
+        settings.tilesPerFrame = options.tilesPerFrame;
+        settings.frameCount = options.captureFrameLimit;
+        settings.outputPrefix = options.captureSettings.outputPath;
+        if (options.fixedDeltaTime > 0.0f) {
+            settings.frameDeltaTime = options.fixedDeltaTime;
+        }
+        std::unique_ptr<SceneStreamer> streamer;
+        if (!options.streaming.directory.empty()) {
+            streamer = std::make_unique<SceneStreamer>(renderer.getScene(), options.streaming);
+        }
+        const size_t workerCount = workers.size();
+        RenderCoordinator coordinator(std::move(workers), renderer.getWidth(), renderer.getHeight(), settings);
+        coordinator.run([&](const InputFrame& input, FrameSnapshot& snapshot) {
+            simulateFrame(input, renderer, streamer.get(), snapshot);
+            // Workers see frames out of order, so the water is stepped here
+            renderer.stepWater(snapshot);
+        });
+        std::cout << "Rendered " << settings.frameCount << " frames on " << workerCount << " workers, "
+                  << coordinator.getReissuedTiles() << " lagging tiles re-issued" << std::endl;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return -1;
+    }
+    return 0;
+}
+
+// Numeric option values must be a whole number (or float) and nothing
+// else; prints what was wrong and returns false otherwise
+template <typename T>
+bool parseOptionValue(const char* option, const char* text, T& value) {
+    std::istringstream in(text);
+    in >> value;
+    // Streams wrap a negative number into an unsigned one instead of failing
+    const bool negativeUnsigned = std::is_unsigned<T>::value && std::strchr(text, '-') != nullptr;
+    if (in.fail() || in.peek() != std::char_traits<char>::eof() || negativeUnsigned) {
+        std::cerr << "Invalid value for " << option << ": " << text << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// A budget in megabytes, stored in bytes
+bool parseBudget(const char* option, const char* text, size_t& bytes) {
+    float megabytes = 0.0f;
+    if (!parseOptionValue(option, text, megabytes)) {
+        return false;
+    }
+    const float maxMegabytes = static_cast<float>(std::numeric_limits<size_t>::max() >> 21);
+    if (!(megabytes >= 0.0f && megabytes <= maxMegabytes)) {
+        std::cerr << "Invalid value for " << option << ": " << text << " (expected megabytes >= 0)" << std::endl;
+        return false;
+    }
+    bytes = static_cast<size_t>(megabytes * 1024.0f * 1024.0f);
+    return true;
+}
+
+bool parseOptions(int argc, char** argv, AppOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (std::strcmp(arg, "--format") == 0 && hasValue) {
+            std::string name = argv[++i];
+            if (!Renderer::parseOutputFormat(name, options.outputFormat)) {
+                std::cerr << "Unknown output format: " << name
+                          << " (expected rgba32f, rgba8, rgb10a2 or r11g11b10f)" << std::endl;
+                return false;
+            }
+        } else if (std::strcmp(arg, "--present") == 0 && hasValue) {
+            std::string mode = argv[++i];
+            if (mode == "quad") {
+                options.presentMode = PresentMode::Quad;
+            } else if (mode == "blit") {
+                options.presentMode = PresentMode::Blit;
+            } else {
+                std::cerr << "Unknown present mode: " << mode << " (expected quad or blit)" << std::endl;
+                return false;
+            }
+        } else if (std::strcmp(arg, "--capture") == 0 && hasValue) {
+            options.capture = true;
+            options.captureSettings.outputPath = argv[++i];
+        } else if (std::strcmp(arg, "--capture-format") == 0 && hasValue) {
+            std::string name = argv[++i];
+            if (!FrameCapture::parseFormat(name, options.captureSettings.format)) {
+                std::cerr << "Unknown capture format: " << name << " (expected png, exr or raw)" << std::endl;
+                return false;
+            }
+        } else if (std::strcmp(arg, "--capture-frames") == 0 && hasValue) {
+            if (!parseOptionValue(arg, argv[++i], options.captureFrameLimit)) {
+                return false;
+            }
+        } else if (std::strcmp(arg, "--capture-drop") == 0) {
+            options.captureSettings.dropWhenBusy = true;
+        } else if (std::strcmp(arg, "--views") == 0 && hasValue) {
+            if (!parseOptionValue(arg, argv[++i], options.viewCount)) {
+                return false;
+            }
+            options.viewCount = std::max(0, options.viewCount);
+        } else if (std::strcmp(arg, "--record") == 0 && hasValue) {
+            options.recordPath = argv[++i];
+        } else if (std::strcmp(arg, "--replay") == 0 && hasValue) {
+            options.replayPath = argv[++i];
+        } else if (std::strcmp(arg, "--fixed-dt") == 0 && hasValue) {
+            if (!parseOptionValue(arg, argv[++i], options.fixedDeltaTime)) {
+                return false;
+            }
+        } else if (std::strcmp(arg, "--unthrottled") == 0) {
+            options.unthrottled = true;
+        } else if (std::strcmp(arg, "--frame-trace") == 0 && hasValue) {
+            options.frameTracePath = argv[++i];
+        } else if (std::strcmp(arg, "--dispatch") == 0 && hasValue) {
+            std::string config = argv[++i];
+            if (!DispatchConfig::parse(config, options.dispatchConfig)) {
+                std::cerr << "Invalid dispatch config: " << config << " (expected e.g. 16x16 or 8x8/morton)" << std::endl;
+                return false;
+            }
+            options.forceDispatch = true;
+        } else if (std::strcmp(arg, "--no-autotune") == 0) {
+            options.autotune = false;
+        } else if (std::strcmp(arg, "--autotune-cache") == 0 && hasValue) {
+            options.autotuneCachePath = argv[++i];
+        } else if (std::strcmp(arg, "--physics-step") == 0 && hasValue) {
+            if (!parseOptionValue(arg, argv[++i], options.physicsStep)) {
+                return false;
+            }
+        } else if (std::strcmp(arg, "--frames-in-flight") == 0 && hasValue) {
+            if (!parseOptionValue(arg, argv[++i], options.framesInFlight)) {
+                return false;
+            }
+            options.framesInFlight = std::max(1, options.framesInFlight);
+        } else if (std::strcmp(arg, "--workers") == 0 && hasValue) {
+            if (!parseOptionValue(arg, argv[++i], options.workerCount)) {
+                return false;
+            }
+            options.workerCount = std::max(0, options.workerCount);
+        } else if (std::strcmp(arg, "--tiles") == 0 && hasValue) {
+            if (!parseOptionValue(arg, argv[++i], options.tilesPerFrame)) {
+                return false;
+            }
+            options.tilesPerFrame = std::max(1, options.tilesPerFrame);
+        } else if (std::strcmp(arg, "--latency") == 0) {
+            options.latency = true;
+        } else if (std::strcmp(arg, "--latency-trace") == 0 && hasValue) {
+            options.latency = true;
+            options.latencyTracePath = argv[++i];
+        } else if (std::strcmp(arg, "--late-latch") == 0) {
+            options.lateLatch = true;
+        } else if (std::strcmp(arg, "--stream-cells") == 0 && hasValue) {
+            options.streaming.directory = argv[++i];
+        } else if (std::strcmp(arg, "--stream-radius") == 0 && hasValue) {
+            if (!parseOptionValue(arg, argv[++i], options.streaming.loadRadius)) {
+                return false;
+            }
+            options.streaming.fullRateRadius = options.streaming.loadRadius * 0.75f;
+        } else if (std::strcmp(arg, "--no-binning") == 0) {
+            options.objectBinning = false;
+        } else if (std::strcmp(arg, "--serve") == 0 && hasValue) {
+            options.serveEndpoint = argv[++i];
+        } else if (std::strcmp(arg, "--debris") == 0 && hasValue) {
+            if (!parseOptionValue(arg, argv[++i], options.debrisCount)) {
+                return false;
+            }
+        } else if (std::strcmp(arg, "--adaptive-aa") == 0 && hasValue) {
+            if (!parseOptionValue(arg, argv[++i], options.adaptiveSamples)) {
+                return false;
+            }
+        } else if (std::strcmp(arg, "--aa-threshold") == 0 && hasValue) {
+            if (!parseOptionValue(arg, argv[++i], options.adaptiveThreshold)) {
+                return false;
+            }
+        } else if (std::strcmp(arg, "--memory-report") == 0 && hasValue) {
+            if (!parseOptionValue(arg, argv[++i], options.memoryReportInterval)) {
+                return false;
+            }
+        } else if (std::strcmp(arg, "--gpu-budget") == 0 && hasValue) {
+            if (!parseBudget(arg, argv[++i], options.gpuBudget)) {
+                return false;
+            }
+        } else if (std::strcmp(arg, "--cpu-budget") == 0 && hasValue) {
+            if (!parseBudget(arg, argv[++i], options.cpuBudget)) {
+                return false;
+            }
+        } else if (std::strcmp(arg, "--perf-view") == 0 && hasValue) {
+            std::string view = argv[++i];
+            const char* const views[] = {"steps", "tests", "noise", "material"};
+            options.perfView = 0;
+            for (int v = 0; v < 4; v++) {
+                if (view == views[v]) {
+                    options.perfView = v + 1;
+                }
+            }
+            if (options.perfView == 0) {
+                std::cerr << "Unknown perf view: " << view << " (expected steps, tests, noise or material)"
+                          << std::endl;
+                return false;
+            }
+        } else if (std::strcmp(arg, "--perf-report") == 0 && hasValue) {
+            if (!parseOptionValue(arg, argv[++i], options.perfReportInterval)) {
+                return false;
+            }
+        } else if (std::strcmp(arg, "--lod-scale") == 0 && hasValue) {
+            if (!parseOptionValue(arg, argv[++i], options.lodScale)) {
+                return false;
+            }
+        } else if (std::strcmp(arg, "--render-path") == 0 && hasValue) {
+            std::string path = argv[++i];
+            if (path == "megakernel") {
+                options.renderPath = RenderPath::Megakernel;
+            } else if (path == "wavefront") {
+                options.renderPath = RenderPath::Wavefront;
+            } else {
+                std::cerr << "Unknown render path: " << path << " (expected megakernel or wavefront)" << std::endl;
+                return false;
+            }
+        } else {
+            std::cerr << "Unknown or incomplete option: " << arg << std::endl;
+            return false;
+        }
+    }
+    if (options.perfView > 0) {
+        // The heatmap is drawn by the quad pass
+        options.presentMode = PresentMode::Quad;
+    }
+    return true;
+}
+
 void framebuffer_size_callback([[maybe_unused]]  GLFWwindow* window, int width, int height) {
     glViewport(0, 0, width, height);
 }
 
-void processInput(GLFWwindow* window, Renderer& renderer, float deltaTime) {
+InputFrame sampleInput(GLFWwindow* window) {
+    InputFrame input;
+
+    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        glfwSetWindowShouldClose(window, true);
+
+    const struct {
+        int glfwKey;
+        InputKey key;
+    } bindings[] = {
+        {GLFW_KEY_W, INPUT_FORWARD},
+        {GLFW_KEY_S, INPUT_BACKWARD},
+        {GLFW_KEY_A, INPUT_LEFT},
+        {GLFW_KEY_D, INPUT_RIGHT},
+        {GLFW_KEY_SPACE, INPUT_JUMP},
+        {GLFW_KEY_R, INPUT_AGE_UP},
+        {GLFW_KEY_F, INPUT_AGE_DOWN},
+        {GLFW_KEY_M, INPUT_MOISTURE_UP},
+        {GLFW_KEY_N, INPUT_MOISTURE_DOWN},
+    };
+    for (const auto& binding : bindings) {
+        if (glfwGetKey(window, binding.glfwKey) == GLFW_PRESS)
+            input.keys |= binding.key;
+    }
+
+    input.mouseDeltaX = pendingMouseX;
+    input.mouseDeltaY = pendingMouseY;
+    pendingMouseX = 0.0f;
+    pendingMouseY = 0.0f;
+    return input;
+}
+
+void processInput(const InputFrame& input, Renderer& renderer) {
+    const float deltaTime = input.deltaTime;
     Camera& camera = renderer.getCamera();
     Physics& physics = renderer.getPhysics();
+
+    if (input.mouseDeltaX != 0.0f || input.mouseDeltaY != 0.0f)
+        camera.processMouseMovement(input.mouseDeltaX, input.mouseDeltaY);
+
     glm::vec3 forward = glm::normalize(glm::vec3(camera.getFront().x, 0.0f, camera.getFront().z));
     glm::vec3 right = camera.getRight();
     glm::vec3 moveForce(0.0f);
     const float MOVE_FORCE = 20.0f;
 
-    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
-        glfwSetWindowShouldClose(window, true);
-
-    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+    if (input.isDown(INPUT_FORWARD))
         moveForce += forward * MOVE_FORCE;
-    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+    if (input.isDown(INPUT_BACKWARD))
         moveForce -= forward * MOVE_FORCE;
-    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+    if (input.isDown(INPUT_LEFT))
         moveForce -= right * MOVE_FORCE;
-    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+    if (input.isDown(INPUT_RIGHT))
         moveForce += right * MOVE_FORCE;
     if (physics.isCameraGrounded()) {
         physics.applyCameraForce(moveForce * deltaTime);
@@ -127,7 +807,7 @@ void processInput(GLFWwindow* window, Renderer& renderer, float deltaTime) {
         // Reduced air control
         physics.applyCameraForce(moveForce * deltaTime * 0.2f);
     }
-    if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS)
+    if (input.isDown(INPUT_JUMP))
         camera.jump();
     camera.update(deltaTime);
 
@@ -135,25 +815,43 @@ void processInput(GLFWwindow* window, Renderer& renderer, float deltaTime) {
     const float rustSpeed = RUST_CHANGE_SPEED * deltaTime;
     const float ageSpeed = 0.5f * deltaTime;
 
-    if (glfwGetKey(window, GLFW_KEY_R) == GLFW_PRESS) {
+    if (input.isDown(INPUT_AGE_UP)) {
         renderer.setFrameWidth(renderer.getFrameWidth() - 0.1f * deltaTime);
         renderer.adjustAge(ageSpeed);
         renderer.adjustRustLevel(rustSpeed);
     }
-    if (glfwGetKey(window, GLFW_KEY_F) == GLFW_PRESS) {
+    if (input.isDown(INPUT_AGE_DOWN)) {
         renderer.setFrameWidth(renderer.getFrameWidth() + 0.1f * deltaTime);
         renderer.adjustAge(-ageSpeed);
         renderer.adjustRustLevel(-rustSpeed);
     }
-    if (glfwGetKey(window, GLFW_KEY_M) == GLFW_PRESS) {
+    if (input.isDown(INPUT_MOISTURE_UP)) {
         renderer.adjustMoisture(0.5f * deltaTime);
     }
-    if (glfwGetKey(window, GLFW_KEY_N) == GLFW_PRESS) {
+    if (input.isDown(INPUT_MOISTURE_DOWN)) {
         renderer.adjustMoisture(-0.5f * deltaTime);
     }
 }
 
-GLuint createQuadVAO() {
+std::vector<CameraView> makeOrbitViews(int count) {
+    // Arc of cameras in front of the wall, all looking at the sphere and painting
+    const glm::vec3 target(0.0f, 0.5f, -2.5f);
+    const float radius = 5.5f;
+    const float height = 1.5f;
+    const float arc = glm::radians(150.0f);
+
+    std::vector<CameraView> views;
+    views.reserve(count);
+    for (int i = 0; i < count; i++) {
+        float t = count > 1 ? static_cast<float>(i) / (count - 1) : 0.5f;
+        float angle = (t - 0.5f) * arc;
+        glm::vec3 position = target + glm::vec3(std::sin(angle) * radius, height, std::cos(angle) * radius);
+        views.push_back({position, glm::normalize(target - position), glm::vec3(0.0f, 1.0f, 0.0f)});
+    }
+    return views;
+}
+
+GLuint createQuadVAO(GLuint& vbo) {
     float quadVertices[] = {
         // positions        // texture coords
         -1.0f,  1.0f, 0.0f, 0.0f, 1.0f,
@@ -165,14 +863,15 @@ GLuint createQuadVAO() {
          1.0f,  1.0f, 0.0f, 1.0f, 1.0f
     };
 
-    GLuint VAO, VBO;
+    GLuint VAO;
     glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &vbo);
 
     glBindVertexArray(VAO);
 
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
     glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), quadVertices, GL_STATIC_DRAW);
+    MemoryTracker::get().trackBuffer(vbo, sizeof(quadVertices), MemoryCategory::Geometry);
 
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
     glEnableVertexAttribArray(0);
@@ -183,7 +882,7 @@ GLuint createQuadVAO() {
     return VAO;
 }
 
-GLuint createQuadProgram() {
+GLuint createQuadProgram(const std::vector<std::string>& defines) {
     // Helper function to compile shader
     auto compileShader = [](const std::string& source, GLenum type) {
         GLuint shader = glCreateShader(type);
@@ -210,6 +909,7 @@ GLuint createQuadProgram() {
     // Preprocess shaders
     vertSource = Renderer::preprocessShader(vertSource, Renderer::getShaderDirectory(vertPath));
     fragSource = Renderer::preprocessShader(fragSource, Renderer::getShaderDirectory(fragPath));
+    fragSource = Renderer::addShaderDefines(fragSource, defines);
 
     GLuint vertShader = compileShader(vertSource, GL_VERTEX_SHADER);
     GLuint fragShader = compileShader(fragSource, GL_FRAGMENT_SHADER);
@@ -234,7 +934,7 @@ GLuint createQuadProgram() {
     return program;
 }
 
-void mouse_callback(GLFWwindow* window, double xposIn, double yposIn) {
+void mouse_callback([[maybe_unused]] GLFWwindow* window, double xposIn, double yposIn) {
     float xpos = static_cast<float>(xposIn);
     float ypos = static_cast<float>(yposIn);
 
@@ -250,6 +950,7 @@ void mouse_callback(GLFWwindow* window, double xposIn, double yposIn) {
     lastX = xpos;
     lastY = ypos;
 
-    Renderer* renderer = static_cast<Renderer*>(glfwGetWindowUserPointer(window));
-    renderer->getCamera().processMouseMovement(xoffset, yoffset);
+    // Applied by processInput so the movement can be recorded and replayed
+    pendingMouseX += xoffset;
+    pendingMouseY += yoffset;
 }
@@ -0,0 +1,43 @@
+#ifndef ADAPTIVE_GLSL
+#define ADAPTIVE_GLSL
+
+// Adaptive supersampling state. The 1 spp trace records one uint per pixel
+// of the traced region: the hit object + 1 (0 for sky) in the high half and
+// the tonemapped luminance in the low half. adaptive/classify.comp appends
+// every pixel on an object edge or a contrast step to the refine list,
+// whose head doubles as the indirect dispatch arguments of the refine pass.
+
+#ifndef ADAPTIVE_GROUP_SIZE
+#define ADAPTIVE_GROUP_SIZE 64
+#endif
+
+layout(std430, binding = 9) buffer AdaptivePixels {
+    uint pixelInfo[];
+};
+
+layout(std430, binding = 10) buffer RefineList {
+    uint refineGroups[3]; // glDispatchComputeIndirect arguments
+    uint refineCount;
+    uint refinePixels[];  // x in the low half, y in the high half
+};
+
+uniform ivec2 regionSize; // pixels traced from pixelOffset
+
+uint packPixelInfo(int object, vec3 color) {
+    float luminance = clamp(dot(color, vec3(0.2126, 0.7152, 0.0722)), 0.0, 1.0);
+    return (uint(object + 1) << 16) | uint(luminance * 65535.0);
+}
+
+int getInfoObject(uint info) {
+    return int(info >> 16) - 1;
+}
+
+float getInfoLuminance(uint info) {
+    return float(info & 0xFFFFu) / 65535.0;
+}
+
+uint getPixelInfoIndex(ivec2 local) {
+    return uint(local.y * regionSize.x + local.x);
+}
+
+#endif // ADAPTIVE_GLSL
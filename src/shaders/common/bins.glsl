@@ -0,0 +1,28 @@
+#ifndef BINS_GLSL
+#define BINS_GLSL
+
+// Per-tile object lists written by binning/bin_objects.comp. The buffer
+// starts with one count per tile plus one for the global list, followed by
+// MAX_BIN_OBJECTS slots per list. Counts past MAX_BIN_OBJECTS mean the list
+// overflowed and is incomplete.
+
+#ifndef MAX_BIN_OBJECTS
+#define MAX_BIN_OBJECTS 64
+#endif
+
+layout(std430, binding = 8) buffer ObjectBins {
+    uint binData[];
+};
+
+uniform ivec2 binGrid; // tiles in x and y
+
+// List of objects every tile tests
+int getGlobalBin() {
+    return binGrid.x * binGrid.y;
+}
+
+uint getBinListStart(int bin) {
+    return uint(getGlobalBin() + 1) + uint(bin) * uint(MAX_BIN_OBJECTS);
+}
+
+#endif // BINS_GLSL
@@ -0,0 +1,31 @@
+#ifndef FRAME_CONSTANTS_GLSL
+#define FRAME_CONSTANTS_GLSL
+
+// Per-frame parameters shared by every pass. Must match FrameConstants in
+// core/frame_constants.hpp.
+layout(std140, binding = 0) uniform FrameConstants {
+    vec3 cameraPosition;
+    float rustLevel;
+    vec3 cameraFront;
+    float age;
+    vec3 cameraUp;
+    float frameWidth;
+    vec3 lightDirection;
+    float lightIntensity;
+    float moisture;
+    float iTime;
+    int numObjects;
+    float lodScale; // multiplies ray cone footprints, 0 disables LOD
+};
+
+#ifdef LATE_LATCH
+// Camera written by the host immediately before the dispatch, fresher than
+// the one in FrameConstants. Must match LatchedCamera in the same header.
+layout(std140, binding = 1) uniform LatchedCamera {
+    vec4 latchedPosition;
+    vec4 latchedFront;
+    vec4 latchedUp;
+};
+#endif
+
+#endif // FRAME_CONSTANTS_GLSL
@@ -1,6 +1,8 @@
 #ifndef NOISE_GLSL
 #define NOISE_GLSL
 
+#include "perf_counters.glsl"
+
 // Hash function for noise
 float hash(vec3 p) {
     p = fract(p * vec3(443.8975, 397.2973, 491.1871));
@@ -10,6 +12,7 @@ float hash(vec3 p) {
 
 // 3D noise function
 float noise(vec3 p) {
+    PERF_COUNT(perfNoiseCalls, 1);
     vec3 i = floor(p);
     vec3 f = fract(p);
     f = f * f * (3.0 - 2.0 * f);
@@ -29,4 +32,19 @@ float noise(vec3 p) {
     );
 }
 
+// Level of detail: weight of a feature of the given spatial frequency
+// (cycles per world unit) on a surface whose pixel footprint is `footprint`
+// world units wide. Features finer than about two pixels fade out.
+float octaveWeight(float frequency, float footprint) {
+    return 1.0 - smoothstep(0.25, 0.5, frequency * footprint);
+}
+
+// noise(p) faded towards its mean as its frequency drops below the pixel
+// footprint; fully filtered octaves are not evaluated at all
+float lodNoise(vec3 p, float frequency, float footprint) {
+    float weight = octaveWeight(frequency, footprint);
+    if (weight <= 0.0) return 0.5;
+    return mix(0.5, noise(p), weight);
+}
+
 #endif // NOISE_GLSL
@@ -0,0 +1,76 @@
+#ifndef OBJECTS_GLSL
+#define OBJECTS_GLSL
+
+#include "uniforms.glsl"
+
+// Scene objects uploaded by Renderer, one record per SceneObject, followed
+// by the records debris/pack.comp writes for GPU-simulated debris. Must
+// match GpuObject in core/gpu_object.hpp.
+struct ObjectRecord {
+    vec3 position;
+    uint info;       // type | material << 8 | age << 16 | rust << 24
+    uvec4 transform; // snorm16 quaternion (xy, zw), half scale xy, half scale z
+};
+
+#ifdef OBJECTS_WRITABLE
+layout(std430, binding = 0) buffer ObjectBuffer {
+#else
+layout(std430, binding = 0) readonly buffer ObjectBuffer {
+#endif
+    ObjectRecord objects[];
+};
+
+const int OBJECT_SPHERE = 0;
+const int OBJECT_RECTANGLE = 1;
+const int OBJECT_GROUND = 2;
+const int OBJECT_WALL = 3;
+
+const uint MATERIAL_SKY = 0u;
+const uint MATERIAL_STEEL = 1u;
+const uint MATERIAL_WOOD = 2u;
+const uint MATERIAL_PAINT = 3u;
+const uint MATERIAL_BRICK = 4u;
+const uint MATERIAL_GROUND = 5u;
+const uint MATERIAL_COUNT = 6u;
+
+vec3 getObjectPosition(int index) {
+    return objects[index].position;
+}
+
+int getObjectType(int index) {
+    return int(objects[index].info & 0xFFu);
+}
+
+uint getObjectMaterial(int index) {
+    return (objects[index].info >> 8) & 0xFFu;
+}
+
+// Per-object aging, never below the global level set from the keyboard
+float getObjectAge(int index) {
+    return max(age, float((objects[index].info >> 16) & 0xFFu) / 255.0);
+}
+
+float getObjectRust(int index) {
+    return max(rustLevel, float(objects[index].info >> 24) / 255.0);
+}
+
+vec4 getObjectRotation(int index) {
+    uvec4 t = objects[index].transform;
+    return vec4(unpackSnorm2x16(t.x), unpackSnorm2x16(t.y));
+}
+
+vec3 getObjectScale(int index) {
+    uvec4 t = objects[index].transform;
+    return vec3(unpackHalf2x16(t.z), unpackHalf2x16(t.w).x);
+}
+
+// Rotates v by the unit quaternion q
+vec3 rotateByQuat(vec3 v, vec4 q) {
+    return v + 2.0 * cross(q.xyz, cross(q.xyz, v) + q.w * v);
+}
+
+vec3 rotateByInverseQuat(vec3 v, vec4 q) {
+    return rotateByQuat(v, vec4(-q.xyz, q.w));
+}
+
+#endif // OBJECTS_GLSL
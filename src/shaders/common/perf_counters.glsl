@@ -0,0 +1,52 @@
+#ifndef PERF_COUNTERS_GLSL
+#define PERF_COUNTERS_GLSL
+
+// Work counters of the instrumented tracer variant. With PERF_COUNTERS
+// defined every invocation tallies its ground march steps, object tests and
+// noise evaluations, and the tracer stores them per pixel together with the
+// shaded material; otherwise PERF_COUNT compiles away. Must match
+// core/perf_counters.hpp.
+
+#if defined(PERF_COUNTERS) || defined(PERF_HEATMAP)
+// Totals over the traced region, also read by the heatmap variant of
+// quad.frag to scale its colours
+layout(std430, binding = 15) buffer PerfTotals {
+    uint totalMarchSteps;
+    uint totalObjectTests;
+    uint totalNoiseCalls;
+    uint totalPixels;
+    uint maxMarchSteps;
+    uint maxObjectTests;
+    uint maxNoiseCalls;
+    uint perfPadding;
+    uint materialPixels[8]; // indexed by MATERIAL_*
+};
+#endif
+
+#ifdef PERF_COUNTERS
+uint perfMarchSteps = 0u;
+uint perfObjectTests = 0u;
+uint perfNoiseCalls = 0u;
+uint perfMaterial = 0u; // MATERIAL_SKY until something is hit
+
+#define PERF_COUNT(counter, amount) counter += uint(amount)
+
+// Steps, tests, noise calls and material of each pixel
+layout(rgba32ui, binding = 3) uniform writeonly uimage2D perfImage;
+
+void storePerfCounters(ivec2 pixel) {
+    imageStore(perfImage, pixel, uvec4(perfMarchSteps, perfObjectTests, perfNoiseCalls, perfMaterial));
+    atomicAdd(totalMarchSteps, perfMarchSteps);
+    atomicAdd(totalObjectTests, perfObjectTests);
+    atomicAdd(totalNoiseCalls, perfNoiseCalls);
+    atomicAdd(totalPixels, 1u);
+    atomicMax(maxMarchSteps, perfMarchSteps);
+    atomicMax(maxObjectTests, perfObjectTests);
+    atomicMax(maxNoiseCalls, perfNoiseCalls);
+    atomicAdd(materialPixels[perfMaterial], 1u);
+}
+#else
+#define PERF_COUNT(counter, amount)
+#endif
+
+#endif // PERF_COUNTERS_GLSL
@@ -1,18 +1,10 @@
 #ifndef UNIFORMS_GLSL
 #define UNIFORMS_GLSL
 
-layout(binding = 1) uniform sampler2D paintingTexture;
+#include "frame_constants.glsl"
 
-uniform float rustLevel;
-uniform float age;
-uniform float frameWidth;
-uniform vec3 cameraPosition;
-uniform vec3 cameraFront;
-uniform vec3 cameraUp;
-uniform int numObjects;
-uniform float moisture;
-uniform vec3 lightDirection;
-uniform float lightIntensity;
-uniform float iTime;
+layout(binding = 1) uniform sampler2D paintingTexture;
+// Ground water simulation state: height, previous height, wetness
+layout(binding = 2) uniform sampler2D waterState;
 
 #endif // UNIFORMS_GLSL
@@ -0,0 +1,47 @@
+#ifndef DEBRIS_GLSL
+#define DEBRIS_GLSL
+
+// Debris spheres simulated by core/gpu_physics. Body state is ping-ponged
+// between two buffers each step; a uniform grid over the room holds a
+// count per cell followed by MAX_CELL_BODIES body slots per cell.
+
+#ifndef MAX_CELL_BODIES
+#define MAX_CELL_BODIES 8
+#endif
+
+struct DebrisBody {
+    vec4 positionRadius;
+    vec4 velocity; // w unused
+};
+
+layout(std430, binding = 11) readonly buffer DebrisIn {
+    DebrisBody bodiesIn[];
+};
+
+layout(std430, binding = 12) writeonly buffer DebrisOut {
+    DebrisBody bodiesOut[];
+};
+
+layout(std430, binding = 13) buffer DebrisGrid {
+    uint gridData[];
+};
+
+uniform int bodyCount;
+uniform vec3 gridOrigin;
+uniform float cellSize;
+uniform ivec3 gridSize;
+
+// Bodies outside the grid share its border cells
+ivec3 getCell(vec3 position) {
+    return clamp(ivec3(floor((position - gridOrigin) / cellSize)), ivec3(0), gridSize - 1);
+}
+
+int getCellIndex(ivec3 cell) {
+    return (cell.z * gridSize.y + cell.y) * gridSize.x + cell.x;
+}
+
+uint getCellSlotStart(int cell) {
+    return uint(gridSize.x * gridSize.y * gridSize.z) + uint(cell) * uint(MAX_CELL_BODIES);
+}
+
+#endif // DEBRIS_GLSL
@@ -0,0 +1,170 @@
+#ifndef HIT_TEST_GLSL
+#define HIT_TEST_GLSL
+
+#include "../common/structures.glsl"
+#include "../common/constants.glsl"
+#include "../common/objects.glsl"
+#include "../common/perf_counters.glsl"
+#include "../materials/material_library.glsl"
+
+// Distance-only intersection tests. They return the hit distance, or a
+// negative value on a miss, and build no material.
+
+const float SPHERE_RADIUS = 1.0;
+const vec3 PAINTING_NORMAL = vec3(0.0, 0.0, 1.0);
+const vec3 PAINTING_UP = vec3(0.0, 1.0, 0.0);
+const float PAINTING_WIDTH = 2.0;
+const float PAINTING_HEIGHT = 1.5;
+const vec3 WALL_NORMAL = vec3(0.0, 0.0, 1.0);
+const float WALL_WIDTH = 10.0;
+const float WALL_HEIGHT = 5.0;
+
+float hitSphere(Ray ray, vec3 center, float radius) {
+    vec3 oc = ray.origin - center;
+    float a = dot(ray.direction, ray.direction);
+    float b = 2.0 * dot(oc, ray.direction);
+    float c = dot(oc, oc) - radius * radius;
+    float discriminant = b * b - 4.0 * a * c;
+
+    if (discriminant < 0.0) return -1.0;
+    return (-b - sqrt(discriminant)) / (2.0 * a);
+}
+
+// Unit sphere rotated and scaled into place. The local ray direction is not
+// renormalized, so the returned t is valid for the world-space ray.
+float hitEllipsoid(Ray ray, vec3 center, vec4 rotation, vec3 scale) {
+    vec3 origin = rotateByInverseQuat(ray.origin - center, rotation) / scale;
+    vec3 direction = rotateByInverseQuat(ray.direction, rotation) / scale;
+    return hitSphere(Ray(origin, direction), vec3(0.0), SPHERE_RADIUS);
+}
+
+vec3 getEllipsoidNormal(vec3 p, vec3 center, vec4 rotation, vec3 scale) {
+    vec3 local = rotateByInverseQuat(p - center, rotation) / scale;
+    return normalize(rotateByQuat(local / scale, rotation));
+}
+
+// Position of p in the rectangle's plane, relative to its center
+vec2 getRectangleLocal(vec3 p, vec3 center, vec3 normal, vec3 up) {
+    vec3 right = normalize(cross(up, normal));
+    vec3 d = p - center;
+    return vec2(dot(d, right), dot(d, up));
+}
+
+float hitRectangle(Ray ray, vec3 center, vec3 normal, vec3 up, float width, float height) {
+    float denom = dot(ray.direction, normal);
+    if (abs(denom) <= 0.0001) return -1.0;
+
+    float t = dot(center - ray.origin, normal) / denom;
+    if (t <= 0.0) return -1.0;
+
+    vec2 local = getRectangleLocal(ray.origin + t * ray.direction, center, normal, up);
+    if (abs(local.x) < width * 0.5 && abs(local.y) < height * 0.5) {
+        return t;
+    }
+    return -1.0;
+}
+
+float hitWall(Ray ray, vec3 position, vec3 normal, vec3 up, float width, float height) {
+    float denom = dot(ray.direction, normal);
+    if (abs(denom) <= 0.0001) return -1.0;
+
+    float t = dot(position - ray.origin, normal) / denom;
+    if (t <= 0.0) return -1.0;
+
+    vec2 local = getRectangleLocal(ray.origin + t * ray.direction, position, normal, up);
+    if (abs(local.x) < width * 0.5 && local.y > 0.0 && local.y < height) {
+        return t;
+    }
+    return -1.0;
+}
+
+float hitGround(Ray ray) {
+    // Ray march the uneven ground
+    float t = 0.0;
+    float maxDist = 100.0;
+    float minDist = 0.001;
+    int maxSteps = 64;
+
+    for (int i = 0; i < maxSteps; i++) {
+        PERF_COUNT(perfMarchSteps, 1);
+        vec3 p = ray.origin + ray.direction * t;
+        float d = p.y - (GROUND_Y + getGroundHeight(p.xz));
+
+        if (d < minDist) return t;
+        if (t > maxDist) break;
+        t += max(d * 0.5, minDist);
+    }
+    return -1.0;
+}
+
+// Orientation of the painting and wall planes for object `index`
+vec3 getObjectNormal(int index, vec3 restNormal) {
+    return rotateByQuat(restNormal, getObjectRotation(index));
+}
+
+vec3 getObjectUp(int index) {
+    return rotateByQuat(vec3(0.0, 1.0, 0.0), getObjectRotation(index));
+}
+
+// Distance to object `index` using its packed transform, negative on a miss
+float hitObject(Ray ray, int index) {
+    vec3 position = getObjectPosition(index);
+    vec3 scale = getObjectScale(index);
+    int type = getObjectType(index);
+
+    if (type == OBJECT_SPHERE) {
+        return hitEllipsoid(ray, position, getObjectRotation(index), scale);
+    } else if (type == OBJECT_RECTANGLE) {
+        return hitRectangle(ray, position, getObjectNormal(index, PAINTING_NORMAL), getObjectUp(index),
+                PAINTING_WIDTH * scale.x, PAINTING_HEIGHT * scale.y);
+    } else if (type == OBJECT_GROUND) {
+        return hitGround(ray);
+    } else if (type == OBJECT_WALL) {
+        return hitWall(ray, position, getObjectNormal(index, WALL_NORMAL), getObjectUp(index),
+                WALL_WIDTH * scale.x, WALL_HEIGHT * scale.y);
+    }
+    return -1.0;
+}
+
+// Bounding sphere of object `index`; false for the unbounded ground
+bool getObjectBounds(int index, out vec3 center, out float radius) {
+    vec3 position = getObjectPosition(index);
+    vec3 scale = getObjectScale(index);
+    int type = getObjectType(index);
+    center = position;
+    radius = 0.0;
+
+    if (type == OBJECT_SPHERE) {
+        radius = SPHERE_RADIUS * max(scale.x, max(scale.y, scale.z));
+        return true;
+    } else if (type == OBJECT_RECTANGLE) {
+        radius = 0.5 * length(vec2(PAINTING_WIDTH * scale.x, PAINTING_HEIGHT * scale.y));
+        return true;
+    } else if (type == OBJECT_WALL) {
+        // The wall rises from its position along its up vector
+        center = position + getObjectUp(index) * (0.5 * WALL_HEIGHT * scale.y);
+        radius = 0.5 * length(vec2(WALL_WIDTH * scale.x, WALL_HEIGHT * scale.y));
+        return true;
+    }
+    return false;
+}
+
+// Material at distance t on `object`, MATERIAL_SKY when nothing was hit.
+// The painting's border is wood.
+uint getSurfaceMaterial(Ray ray, int object, float t) {
+    if (object < 0) {
+        return MATERIAL_SKY;
+    }
+    uint material = getObjectMaterial(object);
+    if (material == MATERIAL_PAINT) {
+        vec2 local = getRectangleLocal(ray.origin + t * ray.direction, getObjectPosition(object),
+                getObjectNormal(object, PAINTING_NORMAL), getObjectUp(object));
+        vec2 halfSize = 0.5 * vec2(PAINTING_WIDTH, PAINTING_HEIGHT) * getObjectScale(object).xy;
+        bool onFrame = abs(local.x) > (halfSize.x - frameWidth) ||
+                abs(local.y) > (halfSize.y - frameWidth);
+        return onFrame ? MATERIAL_WOOD : MATERIAL_PAINT;
+    }
+    return material;
+}
+
+#endif // HIT_TEST_GLSL
@@ -2,6 +2,7 @@
 #define RAY_GLSL
 
 #include "../common/structures.glsl"
+#include "../common/uniforms.glsl"
 
 Ray createRay(vec3 origin, vec3 direction) {
     Ray ray;
@@ -10,4 +11,17 @@ Ray createRay(vec3 origin, vec3 direction) {
     return ray;
 }
 
+// Ray cones: a primary ray starts with zero width and widens by `spread`
+// (radians) per unit of distance, one pixel's angle. The footprint on a
+// surface is stretched by 1/cos at grazing angles; the geometric mean of the
+// ellipse axes keeps the width isotropic without overblurring.
+float getPixelSpreadAngle(int imageHeight) {
+    return 2.0 * tan(radians(45.0)) / float(imageHeight);
+}
+
+float getConeFootprint(float t, float spread, vec3 direction, vec3 normal) {
+    float cosTheta = max(abs(dot(direction, normal)), 0.05);
+    return t * spread * lodScale / sqrt(cosTheta);
+}
+
 #endif // RAY_GLSL
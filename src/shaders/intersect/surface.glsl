@@ -0,0 +1,55 @@
+#ifndef SURFACE_GLSL
+#define SURFACE_GLSL
+
+#include "../common/structures.glsl"
+#include "../common/constants.glsl"
+#include "../common/uniforms.glsl"
+#include "hit_test.glsl"
+#include "ray.glsl"
+
+// Deferred material evaluation: callers find the closest hit with the
+// distance-only tests in hit_test.glsl, then build the surface once.
+// `spread` is the ray cone's widening per unit distance (see ray.glsl); the
+// resulting footprint selects the material detail.
+
+// Full surface of `object` at distance t, shaded as `material` (one of
+// getSurfaceMaterial's results). A constant material folds the branches.
+HitInfo evaluateSurface(Ray ray, float spread, int object, uint material, float t) {
+    HitInfo hit;
+    hit.hit = true;
+    hit.t = t;
+    hit.position = ray.origin + t * ray.direction;
+    vec3 objPos = getObjectPosition(object);
+    vec4 rotation = getObjectRotation(object);
+
+    if (material == MATERIAL_STEEL) {
+        // Rust is patterned in object space so it moves with the object
+        vec3 normal = getEllipsoidNormal(hit.position, objPos, rotation, getObjectScale(object));
+        vec3 local = rotateByInverseQuat(hit.position - objPos, rotation);
+        hit.material = createSteelMaterial(getObjectRust(object), local, normal,
+                getConeFootprint(t, spread, ray.direction, normal));
+        // Use the perturbed normal from the material
+        hit.normal = hit.material.normal;
+    } else if (material == MATERIAL_WOOD) {
+        hit.normal = rotateByQuat(PAINTING_NORMAL, rotation);
+        hit.material = createWoodMaterial(hit.position, getObjectAge(object),
+                getConeFootprint(t, spread, ray.direction, hit.normal));
+    } else if (material == MATERIAL_PAINT) {
+        hit.normal = rotateByQuat(PAINTING_NORMAL, rotation);
+        vec2 local = getRectangleLocal(hit.position, objPos, hit.normal, rotateByQuat(PAINTING_UP, rotation));
+        vec2 uv = local / (vec2(PAINTING_WIDTH, PAINTING_HEIGHT) * getObjectScale(object).xy) + 0.5;
+        hit.material = createPaintMaterial(uv, hit.position, getObjectAge(object),
+                getConeFootprint(t, spread, ray.direction, hit.normal));
+    } else if (material == MATERIAL_BRICK) {
+        hit.normal = rotateByQuat(WALL_NORMAL, rotation);
+        hit.material = createBrickMaterial(hit.position, hit.normal,
+                getConeFootprint(t, spread, ray.direction, hit.normal));
+    } else {
+        hit.normal = calculateGroundNormal(hit.position.xz);
+        hit.material = createGroundMaterial(hit.position, hit.normal, -ray.direction,
+                getConeFootprint(t, spread, ray.direction, hit.normal));
+    }
+    return hit;
+}
+
+#endif // SURFACE_GLSL
@@ -4,6 +4,7 @@
 #include "../common/structures.glsl"
 #include "../common/noise.glsl"
 #include "../common/uniforms.glsl"
+#include "water.glsl"
 
 const vec3 STEEL_COLOR = vec3(0.8, 0.8, 0.8);
 const vec3 RUST_COLOR = vec3(0.6, 0.2, 0.1);
@@ -32,18 +33,6 @@ Material createGoldMaterial() {
     );
 }
 
-float createRipplePattern(vec3 pos) {
-    float ripple = 0.0;
-    // Create multiple ripple centers with more pronounced effect
-    for (int i = 0; i < 5; i++) {
-        vec2 center = vec2(sin(iTime * 0.5 + i), cos(iTime * 0.3 + i)) * 2.0;
-        float dist = length(pos.xz - center);
-        float wave = sin(dist * 8.0 - iTime * 3.0) * 0.8 + 0.2; // Increased amplitude
-        ripple += wave * exp(-dist * 1.5); // Slower falloff
-    }
-    return ripple;
-}
-
 float getGroundHeight(vec2 pos) {
     // Create crater pattern
     float crater1 = exp(-length(pos + vec2(1.0, 0.5)) * 1.5);
@@ -86,7 +75,7 @@ vec3 calculateRustColor(vec4 rustPattern) {
     return rustColor;
 }
 
-vec4 getRustPattern(vec3 pos, float rustLevel) {
+vec4 getRustPattern(vec3 pos, float rustLevel, float footprint) {
     // Basic noise scales
     const float largeScale = 2.0;
     const float mediumScale = 5.0;
@@ -94,16 +83,16 @@ vec4 getRustPattern(vec3 pos, float rustLevel) {
     const float microScale = 30.0;
 
     // Base rust pattern (large areas)
-    float baseRust = noise(pos * largeScale);
+    float baseRust = lodNoise(pos * largeScale, largeScale, footprint);
 
     // Medium detail
-    float mediumDetail = noise(pos * mediumScale + vec3(baseRust));
+    float mediumDetail = lodNoise(pos * mediumScale + vec3(baseRust), mediumScale, footprint);
 
     // Fine detail (cracks and spots)
-    float fineDetail = noise(pos * smallScale + vec3(mediumDetail));
+    float fineDetail = lodNoise(pos * smallScale + vec3(mediumDetail), smallScale, footprint);
 
     // Micro detail (surface roughness)
-    float microDetail = noise(pos * microScale);
+    float microDetail = lodNoise(pos * microScale, microScale, footprint);
 
     // Combine patterns with different weights
     float rustPattern = baseRust * 0.5 +
@@ -113,7 +102,7 @@ vec4 getRustPattern(vec3 pos, float rustLevel) {
 
     // Create edge weathering effect
     float edgeRust = pow(1.0 - abs(dot(normalize(pos), vec3(0.0, 1.0, 0.0))), 3.0);
-    float moistureEffect = noise(pos * 25.0) * moisture;
+    float moistureEffect = lodNoise(pos * 25.0, 25.0, footprint) * moisture;
 
     // Enhance rust formation in areas with high moisture
     float moistureRust = smoothstep(0.4, 0.6, moistureEffect);
@@ -144,7 +133,7 @@ vec3 getWetSurfaceColor(vec3 baseColor, vec3 normal, vec3 viewDir) {
     return mix(baseColor, wetColor, wetness * (0.5 + 0.5 * fresnel));
 }
 
-Material createGroundMaterial(vec3 pos, vec3 normal, vec3 viewDir) {
+Material createGroundMaterial(vec3 pos, vec3 normal, vec3 viewDir, float footprint) {
     // Create base material
     Material mat = createBasicMaterial(
             vec3(0.2, 0.18, 0.15), // Slightly darker ground color
@@ -159,7 +148,7 @@ Material createGroundMaterial(vec3 pos, vec3 normal, vec3 viewDir) {
 
     // Add rust effect to crater rims
     float rustAmount = craterRim * rustLevel;
-    vec4 rustPattern = getRustPattern(pos, rustAmount);
+    vec4 rustPattern = getRustPattern(pos, rustAmount, footprint);
     vec3 rustColor = calculateRustColor(rustPattern);
 
     // Mix ground color with rust
@@ -167,13 +156,18 @@ Material createGroundMaterial(vec3 pos, vec3 normal, vec3 viewDir) {
     mat.metallic = mix(0.0, 0.3, rustPattern.x);
     mat.roughness = mix(mat.roughness, 0.7, rustPattern.x);
 
+    // Rain and splashes leave the surface darker and glossier
+    float wetness = getWaterWetness(pos);
+    mat.albedo *= 1.0 - wetness * 0.4;
+    mat.roughness = mix(mat.roughness, 0.4, wetness);
+
     float craterDepth = -getGroundHeight(pos.xz);
-    float puddlePattern = smoothstep(0.1, 0.3, craterDepth) * moisture;
+    float puddlePattern = smoothstep(0.1, 0.3, craterDepth) * max(moisture, wetness);
 
     if (puddlePattern > 0.01) {
-        // More pronounced ripple effect
-        float ripple = createRipplePattern(pos);
-        mat.normal = normalize(normal + vec3(ripple * moisture * 0.3, 0.0, ripple * moisture * 0.3));
+        // Ripples from the simulated water surface
+        vec2 slope = getWaterSlope(pos, footprint);
+        mat.normal = normalize(normal - vec3(slope.x, 0.0, slope.y) * puddlePattern);
 
         // More reflective puddles
         vec3 puddleColor = vec3(0.02, 0.02, 0.03);
@@ -186,34 +180,39 @@ Material createGroundMaterial(vec3 pos, vec3 normal, vec3 viewDir) {
     return mat;
 }
 
-vec3 calculateRustNormal(vec3 pos, vec4 rustPattern, vec3 normal) {
+vec3 calculateRustNormal(vec3 pos, vec4 rustPattern, vec3 normal, float footprint) {
+    // The bumps come from the medium and finer octaves; once those are
+    // filtered out the six extra pattern evaluations are skipped
+    float bumpWeight = octaveWeight(5.0, footprint);
+    if (bumpWeight <= 0.0) return normal;
+
     // Calculate normal perturbation based on rust pattern
     float eps = 0.01;
     vec3 dx = vec3(eps, 0.0, 0.0);
     vec3 dy = vec3(0.0, eps, 0.0);
     vec3 dz = vec3(0.0, 0.0, eps);
 
-    float rx = getRustPattern(pos + dx, 1.0).w - getRustPattern(pos - dx, 1.0).w;
-    float ry = getRustPattern(pos + dy, 1.0).w - getRustPattern(pos - dy, 1.0).w;
-    float rz = getRustPattern(pos + dz, 1.0).w - getRustPattern(pos - dz, 1.0).w;
+    float rx = getRustPattern(pos + dx, 1.0, footprint).w - getRustPattern(pos - dx, 1.0, footprint).w;
+    float ry = getRustPattern(pos + dy, 1.0, footprint).w - getRustPattern(pos - dy, 1.0, footprint).w;
+    float rz = getRustPattern(pos + dz, 1.0, footprint).w - getRustPattern(pos - dz, 1.0, footprint).w;
 
     vec3 tangent = normalize(cross(normal, vec3(0.0, 1.0, 0.0)));
     vec3 bitangent = normalize(cross(normal, tangent));
 
     // Construct perturbed normal
-    vec3 bumpNormal = normalize(normal + (tangent * rx + bitangent * ry + normal * rz) * rustPattern.w * 10.0);
+    vec3 bumpNormal = normalize(normal + (tangent * rx + bitangent * ry + normal * rz) * rustPattern.w * 10.0 * bumpWeight);
     return bumpNormal;
 }
 
-Material createSteelMaterial(float rustLevel, vec3 worldPos, vec3 normal) {
+Material createSteelMaterial(float rustLevel, vec3 worldPos, vec3 normal, float footprint) {
     // Get rust pattern and displacement
-    vec4 rustPattern = getRustPattern(worldPos, rustLevel);
+    vec4 rustPattern = getRustPattern(worldPos, rustLevel, footprint);
 
     // Calculate final color
     vec3 baseColor = calculateRustColor(rustPattern);
 
     // Calculate perturbed normal
-    vec3 bumpedNormal = calculateRustNormal(worldPos, rustPattern, normal);
+    vec3 bumpedNormal = calculateRustNormal(worldPos, rustPattern, normal, footprint);
 
     // Adjust material properties based on rust
     float pattern = rustPattern.x;
@@ -229,22 +228,22 @@ Material createSteelMaterial(float rustLevel, vec3 worldPos, vec3 normal) {
     return mat;
 }
 
-float woodNoise(vec3 pos) {
-    float grain = noise(pos * vec3(10.0, 1.0, 1.0));
-    float rings = noise(pos * vec3(20.0, 2.0, 2.0));
+float woodNoise(vec3 pos, float footprint) {
+    float grain = lodNoise(pos * vec3(10.0, 1.0, 1.0), 10.0, footprint);
+    float rings = lodNoise(pos * vec3(20.0, 2.0, 2.0), 20.0, footprint);
     return mix(grain, rings, 0.5);
 }
 
-Material createWoodMaterial(vec3 pos, float age) {
+Material createWoodMaterial(vec3 pos, float age, float footprint) {
     vec3 lightWood = vec3(0.7, 0.4, 0.2);
     vec3 darkWood = vec3(0.3, 0.2, 0.1);
 
     // Wood grain pattern
-    float grain = woodNoise(pos);
+    float grain = woodNoise(pos, footprint);
 
     // Age effects
-    float crack = noise(pos * 50.0 + age * 10.0);
-    float weathering = noise(pos * 2.0 + age * 5.0);
+    float crack = lodNoise(pos * 50.0 + age * 10.0, 50.0, footprint);
+    float weathering = lodNoise(pos * 2.0 + age * 5.0, 2.0, footprint);
 
     // Darken and add variation with age
     vec3 woodColor = mix(lightWood, darkWood, grain);
@@ -267,19 +266,19 @@ Material createWoodMaterial(vec3 pos, float age) {
     );
 }
 
-Material createPaintMaterial(vec2 uv, vec3 pos, float age) {
+Material createPaintMaterial(vec2 uv, vec3 pos, float age, float footprint) {
     // Sample base painting color
     vec3 paintColor = texture(paintingTexture, uv).rgb;
 
     // Cracking pattern
     float crackScale = 20.0 + age * 30.0;
     vec3 crackPos = pos * crackScale;
-    float crack = noise(crackPos);
+    float crack = lodNoise(crackPos, crackScale, footprint);
     float crackling = smoothstep(0.6, 0.7, crack) * age;
 
     // Peeling pattern
     float peelScale = 5.0 + age * 10.0;
-    float peel = noise(pos * peelScale + age * 2.0);
+    float peel = lodNoise(pos * peelScale + age * 2.0, peelScale, footprint);
     float peeling = smoothstep(0.7, 0.8, peel) * age;
 
     // Color aging
@@ -308,7 +307,11 @@ Material createPaintMaterial(vec2 uv, vec3 pos, float age) {
     );
 }
 
-vec3 getBrickColor(vec3 pos) {
+// Mortar lines are 0.01 world units wide; wider footprints see the average
+const float MORTAR_FREQUENCY = 100.0;
+const float MORTAR_COVERAGE = 0.28;
+
+vec3 getBrickColor(vec3 pos, float footprint) {
     // Brick size and mortar thickness
     vec2 brickSize = vec2(0.4, 0.2);
     vec2 mortarThickness = vec2(0.02, 0.02);
@@ -337,28 +340,34 @@ vec3 getBrickColor(vec3 pos) {
     vec3 mortarColor = vec3(0.8, 0.8, 0.8);
 
     // Add some variation to brick color
-    float variation = noise(pos * 10.0);
+    float variation = lodNoise(pos * 10.0, 10.0, footprint);
     brickBase *= 0.8 + variation * 0.4;
 
     // Return either brick or mortar color
-    return inMortar ? mortarColor : brickBase;
+    vec3 color = inMortar ? mortarColor : brickBase;
+    vec3 averageColor = mix(brickBase, mortarColor, MORTAR_COVERAGE);
+    return mix(averageColor, color, octaveWeight(MORTAR_FREQUENCY, footprint));
 }
 
-Material createBrickMaterial(vec3 pos, vec3 normal) {
-    vec3 baseColor = getBrickColor(pos);
+Material createBrickMaterial(vec3 pos, vec3 normal, float footprint) {
+    vec3 baseColor = getBrickColor(pos, footprint);
 
-    // Calculate bump mapping for mortar lines
-    float eps = 0.01;
-    vec3 dx = vec3(eps, 0.0, 0.0);
-    vec3 dy = vec3(0.0, eps, 0.0);
+    // Calculate bump mapping for mortar lines, skipped once they are
+    // narrower than a pixel
+    vec3 bumpedNormal = normal;
+    if (octaveWeight(MORTAR_FREQUENCY, footprint) > 0.0) {
+        float eps = 0.01;
+        vec3 dx = vec3(eps, 0.0, 0.0);
+        vec3 dy = vec3(0.0, eps, 0.0);
 
-    float bx = float(getBrickColor(pos + dx).r) - float(getBrickColor(pos - dx).r);
-    float by = float(getBrickColor(pos + dy).r) - float(getBrickColor(pos - dy).r);
+        float bx = float(getBrickColor(pos + dx, footprint).r) - float(getBrickColor(pos - dx, footprint).r);
+        float by = float(getBrickColor(pos + dy, footprint).r) - float(getBrickColor(pos - dy, footprint).r);
 
-    // Create perturbed normal for bump mapping
-    vec3 tangent = normalize(cross(normal, vec3(0.0, 1.0, 0.0)));
-    vec3 bitangent = normalize(cross(normal, tangent));
-    vec3 bumpedNormal = normalize(normal + (tangent * bx + bitangent * by) * 0.5);
+        // Create perturbed normal for bump mapping
+        vec3 tangent = normalize(cross(normal, vec3(0.0, 1.0, 0.0)));
+        vec3 bitangent = normalize(cross(normal, tangent));
+        bumpedNormal = normalize(normal + (tangent * bx + bitangent * by) * 0.5);
+    }
 
     return createBasicMaterial(
         baseColor,
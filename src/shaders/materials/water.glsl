@@ -0,0 +1,33 @@
+#ifndef WATER_GLSL
+#define WATER_GLSL
+
+#include "../common/noise.glsl"
+#include "../common/uniforms.glsl"
+
+// Sampling of the ground water simulation. Must match WaterSimulation::EXTENT.
+const float WATER_EXTENT = 16.0;
+
+vec2 getWaterUV(vec3 pos) {
+    return pos.xz / WATER_EXTENT + 0.5;
+}
+
+// Slope of the simulated surface in x and z, faded out once ripples are
+// finer than the pixel footprint
+vec2 getWaterSlope(vec3 pos, float footprint) {
+    float resolution = float(textureSize(waterState, 0).x);
+    float texelSize = WATER_EXTENT / resolution;
+    float weight = octaveWeight(0.5 / texelSize, footprint);
+    if (weight <= 0.0) return vec2(0.0);
+
+    vec2 uv = getWaterUV(pos);
+    vec2 du = vec2(1.0 / resolution, 0.0);
+    float dx = texture(waterState, uv + du.xy).r - texture(waterState, uv - du.xy).r;
+    float dz = texture(waterState, uv + du.yx).r - texture(waterState, uv - du.yx).r;
+    return vec2(dx, dz) / (2.0 * texelSize) * weight;
+}
+
+float getWaterWetness(vec3 pos) {
+    return texture(waterState, getWaterUV(pos)).b;
+}
+
+#endif // WATER_GLSL
@@ -1,9 +1,56 @@
 #version 430 core
+#include "common/frame_constants.glsl"
+#include "common/perf_counters.glsl"
+
 in vec2 TexCoord;
 out vec4 FragColor;
 
 uniform sampler2D screenTexture;
 
+#ifdef PERF_HEATMAP
+// Cost heatmap over the image, built only when asked for as it reads a
+// storage block: 1 shows ground march steps, 2 object tests, 3 noise calls
+// (each scaled to the frame's maximum) and 4 the material each pixel was
+// shaded as. Needs the PERF_COUNTERS tracer.
+uniform int debugView;
+uniform usampler2D perfTexture;
+
+// Blue through green to red
+vec3 heatColor(float value) {
+    value = clamp(value, 0.0, 1.0);
+    return clamp(vec3(1.5 - abs(4.0 * value - vec3(3.0, 2.0, 1.0))), 0.0, 1.0);
+}
+
+vec3 materialColor(uint material) {
+    const vec3 colors[6] = vec3[](
+        vec3(0.1, 0.1, 0.3),  // sky
+        vec3(0.7, 0.7, 0.8),  // steel
+        vec3(0.6, 0.35, 0.1), // wood
+        vec3(0.9, 0.2, 0.7),  // paint
+        vec3(0.8, 0.25, 0.1), // brick
+        vec3(0.3, 0.6, 0.2)   // ground
+    );
+    return colors[min(material, 5u)];
+}
+
+void main() {
+    uvec4 counts = texture(perfTexture, TexCoord);
+    vec3 color;
+    if (debugView == 1) {
+        color = heatColor(float(counts.x) / float(max(maxMarchSteps, 1u)));
+    } else if (debugView == 2) {
+        color = heatColor(float(counts.y) / float(max(maxObjectTests, 1u)));
+    } else if (debugView == 3) {
+        color = heatColor(float(counts.z) / float(max(maxNoiseCalls, 1u)));
+    } else {
+        color = materialColor(counts.w);
+    }
+    // A little of the render shows through for orientation
+    vec3 scene = texture(screenTexture, TexCoord).rgb;
+    FragColor = vec4(mix(color, scene, 0.15), 1.0);
+}
+#else
 void main() {
     FragColor = texture(screenTexture, TexCoord);
 }
+#endif
@@ -0,0 +1,58 @@
+#ifndef QUEUES_GLSL
+#define QUEUES_GLSL
+
+// Work queues shared by the wavefront stages. Must match the buffer layout
+// set up by WavefrontPipeline.
+
+#include "../common/objects.glsl"
+
+// Indices into dispatchArgs
+const uint DISPATCH_INTERSECT = 0u;
+const uint DISPATCH_SORT = 1u;
+const uint DISPATCH_SHADE = 2u; // + material
+
+const uint WAVEFRONT_GROUP_SIZE = 64u;
+
+struct RayRecord {
+    vec4 origin; // xyz origin, w ray cone spread angle
+    vec3 direction;
+    uint pixel;  // linear pixel index the ray contributes to
+};
+
+struct HitRecord {
+    uint ray;
+    int object;
+    float t;
+    uint material;
+};
+
+layout(std430, binding = 3) buffer RayQueue {
+    RayRecord rays[];
+};
+
+layout(std430, binding = 4) buffer HitQueue {
+    HitRecord hits[];
+};
+
+layout(std430, binding = 5) buffer SortedHitQueue {
+    HitRecord sortedHits[];
+};
+
+layout(std430, binding = 6) buffer QueueCounters {
+    uint rayCount;
+    uint hitCount;
+    uint materialCounts[MATERIAL_COUNT];
+    uint materialOffsets[MATERIAL_COUNT];
+    uint scatterCursor[MATERIAL_COUNT];
+};
+
+// x, y, z workgroup counts for glDispatchComputeIndirect, w unused
+layout(std430, binding = 7) buffer DispatchArgs {
+    uvec4 dispatchArgs[];
+};
+
+uvec4 groupsFor(uint count) {
+    return uvec4((count + WAVEFRONT_GROUP_SIZE - 1u) / WAVEFRONT_GROUP_SIZE, 1u, 1u, 0u);
+}
+
+#endif // QUEUES_GLSL
@@ -0,0 +1,121 @@
+// Offline texture cook: decodes images once and writes .gtex containers
+// (core/texture_container.hpp) with the whole mip chain baked in, so the
+// renderer can upload them without decoding or generating mipmaps.
+//
+//   texture_cook <image>...           writes <image without extension>.gtex
+//   texture_cook <image> -o <file>    writes one container to <file>
+
+#include "core/image_loader.hpp"
+#include "core/texture_container.hpp"
+#include <glad/glad.h>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Tap {
+    uint32_t index;
+    float weight;
+};
+
+// Source texels and weights covering destination texel `x` when `size`
+// texels shrink to max(size / 2, 1). Even sizes average pairs; odd ones
+// spread each destination texel over three texels so the last row and
+// column still contribute.
+std::vector<Tap> footprint(uint32_t x, uint32_t size) {
+    if (size == 1) {
+        return {{0, 1.0f}};
+    }
+    if (size % 2 == 0) {
+        return {{x * 2, 0.5f}, {x * 2 + 1, 0.5f}};
+    }
+    const uint32_t half = size / 2;
+    const float scale = 1.0f / static_cast<float>(size);
+    return {{x * 2, (half - x) * scale}, {x * 2 + 1, half * scale}, {x * 2 + 2, (x + 1) * scale}};
+}
+
+// Box filter over each destination texel's exact footprint
+TextureLevelData downsample(const TextureLevelData& source) {
+    TextureLevelData level;
+    level.width = std::max(source.width / 2, 1u);
+    level.height = std::max(source.height / 2, 1u);
+    level.pixels.resize(static_cast<size_t>(level.width) * level.height * 4);
+    for (uint32_t y = 0; y < level.height; y++) {
+        const std::vector<Tap> rows = footprint(y, source.height);
+        for (uint32_t x = 0; x < level.width; x++) {
+            const std::vector<Tap> columns = footprint(x, source.width);
+            float sum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+            for (const Tap& row : rows) {
+                for (const Tap& column : columns) {
+                    const uint8_t* texel =
+                        &source.pixels[(static_cast<size_t>(row.index) * source.width + column.index) * 4];
+                    for (uint32_t c = 0; c < 4; c++) {
+                        sum[c] += texel[c] * row.weight * column.weight;
+                    }
+                }
+            }
+            for (uint32_t c = 0; c < 4; c++) {
+                level.pixels[(static_cast<size_t>(y) * level.width + x) * 4 + c] =
+                    static_cast<uint8_t>(std::min(sum[c] + 0.5f, 255.0f));
+            }
+        }
+    }
+    return level;
+}
+
+void cook(const std::string& input, const std::string& output) {
+    int width, height, channels;
+    // Same orientation as the runtime loader used to produce
+    stbi_set_flip_vertically_on_load(true);
+    // Expanded to RGBA8: rows stay 4-byte aligned and it is what drivers
+    // store RGB8 as anyway
+    unsigned char* data = stbi_load(input.c_str(), &width, &height, &channels, 4);
+    if (!data) {
+        throw std::runtime_error("Failed to load " + input + ": " + stbi_failure_reason());
+    }
+
+    std::vector<TextureLevelData> levels(1);
+    levels[0].width = static_cast<uint32_t>(width);
+    levels[0].height = static_cast<uint32_t>(height);
+    levels[0].pixels.assign(data, data + static_cast<size_t>(width) * height * 4);
+    stbi_image_free(data);
+    while (levels.back().width > 1 || levels.back().height > 1) {
+        levels.push_back(downsample(levels.back()));
+    }
+
+    writeTextureContainer(output, GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, levels);
+    std::cout << input << " -> " << output << " (" << width << "x" << height << ", " << levels.size()
+              << " levels)" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> inputs;
+    std::string output;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            output = argv[++i];
+        } else {
+            inputs.push_back(argv[i]);
+        }
+    }
+    if (inputs.empty() || (!output.empty() && inputs.size() != 1)) {
+        std::cerr << "Usage: " << argv[0] << " <image>... | <image> -o <output.gtex>" << std::endl;
+        return 1;
+    }
+
+    try {
+        for (const auto& input : inputs) {
+            cook(input, output.empty() ? getCookedTexturePath(input) : output);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}